@@ -39,6 +39,42 @@ int main(int argc, char **argv)
         merry_destroy_parser(_parsed_options);
         return -1;
     }
+    // the scheduler and the size of the core table must be known before the VM is initialized
+    if (_parsed_options->options[_OPT_WORKERS].provided == mtrue)
+    {
+        char *end;
+        msize_t workers = strtoull(*_parsed_options->options[_OPT_WORKERS]._given_value_str_, &end, 10);
+        if (*end != '\0' || merry_os_set_workers(workers) == RET_FAILURE)
+        {
+            if (*end != '\0')
+                fprintf(stderr, "Error: Expected a number after '-w', got '%s'.\n", *_parsed_options->options[_OPT_WORKERS]._given_value_str_);
+            merry_destroy_parser(_parsed_options);
+            return -1;
+        }
+    }
+    if (_parsed_options->options[_OPT_MAX_CORES].provided == mtrue)
+    {
+        char *end;
+        msize_t cores = strtoull(*_parsed_options->options[_OPT_MAX_CORES]._given_value_str_, &end, 10);
+        if (*end != '\0' || merry_os_set_max_cores(cores) == RET_FAILURE)
+        {
+            if (*end != '\0')
+                fprintf(stderr, "Error: Expected a number after '-c', got '%s'.\n", *_parsed_options->options[_OPT_MAX_CORES]._given_value_str_);
+            merry_destroy_parser(_parsed_options);
+            return -1;
+        }
+    }
+    // where the cores and the memory go must be known before anything is created
+    if (_parsed_options->options[_OPT_PIN_CPUS].provided == mtrue || _parsed_options->options[_OPT_NUMA].provided == mtrue || _parsed_options->options[_OPT_DATA_POLICY].provided == mtrue)
+    {
+        mcstr_t cpus = _parsed_options->options[_OPT_PIN_CPUS].provided == mtrue ? *_parsed_options->options[_OPT_PIN_CPUS]._given_value_str_ : NULL;
+        mbool_t interleave = _parsed_options->options[_OPT_DATA_POLICY].provided == mtrue && strcmp(*_parsed_options->options[_OPT_DATA_POLICY]._given_value_str_, "interleave") == 0;
+        if (merry_os_set_placement(cpus, _parsed_options->options[_OPT_NUMA].provided, interleave) == RET_FAILURE)
+        {
+            merry_destroy_parser(_parsed_options);
+            return -1;
+        }
+    }
     // Now since we don't have any fancy or complex options to handle, let's get straight to business
     merry_logger_init(_parsed_options->options[_OPT_ENABLE_LOGGER].provided == mtrue ? mtrue : mfalse); // we won't enable logging yet, this is just an option rn
     if (merry_os_init(*_parsed_options->options[_OPT_FILE]._given_value_str_) == RET_FAILURE)
@@ -21,6 +21,16 @@ enum
     MERRY_DYNL_FAILED,             // failed to load library
     MERRY_DYNCALL_FAILED,          // failed to make a function call
     MERRY_FILEHANDLE_NULL,         // performing operations on a NULL file
+    MERRY_INVALID_FILEHANDLE,      // the handle doesn't belong to any open file
+    MERRY_INVALID_IOV,             // too many buffers for a vectored read or write
+    MERRY_MEM_READ_ONLY,           // storing to memory that a file is mapped to read-only
+    MERRY_INVALID_ASYNC_REQUEST,   // the request can't be made asynchronously
+    MERRY_ASYNC_SLOTS_FULL,        // too many asynchronous requests in flight
+    MERRY_INVALID_TICKET,          // the ticket doesn't belong to a request in flight
+    MERRY_DYNBIND_FAILED,          // the function couldn't be bound to a slot
+    MERRY_INVALID_DYNSLOT,         // nothing is bound to the slot
+    MERRY_DYNSIG_FAILED,           // the signature couldn't be given to the slot
+    MERRY_INVALID_INTRINSIC,       // no intrinsic has the index
 };
 
 #endif
\ No newline at end of file
@@ -5,7 +5,7 @@
 #include <stdlib.h>
 #include "merry_os.h"
 
-#define _MERRY_MAX_OPTIONS_ 4 // I mean this is given. The person can't ask anything to move both forward and backward at the same time. But this is actually not representing the limit
+#define _MERRY_MAX_OPTIONS_ 9 // I mean this is given. The person can't ask anything to move both forward and backward at the same time. But this is actually not representing the limit
                               // this represents the number of options
 
 typedef enum MerryCLOption_t MerryCLOption_t;
@@ -19,6 +19,11 @@ enum MerryCLOption_t
     _OPT_VER,           // -v, --v, -version, --version
     _OPT_ENABLE_LOGGER, // -l [The use of this flag doesn't ensure that the log file will be generated]
                         // the logger may fail to get initialized and enabling the logger slows down the performance of the VM
+    _OPT_PIN_CPUS,      // -p <list of CPUs>
+    _OPT_NUMA,          // -n
+    _OPT_DATA_POLICY,   // -m <interleave|local>
+    _OPT_WORKERS,       // -w <number of workers>
+    _OPT_MAX_CORES,     // -c <most cores at once>
 };
 
 struct MerryCLOption
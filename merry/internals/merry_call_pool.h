@@ -0,0 +1,120 @@
+/*
+ * Call pool for the Merry VM
+ * MIT License
+ *
+ * Copyright (c) 2024 MegrajChauhan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _MERRY_CALL_POOL_
+#define _MERRY_CALL_POOL_
+
+// Calls the functions that were given a timeout(DYNTIMEOUT) from dynamically loaded libraries
+// Every call gets a worker thread of its own and a watchdog gives up on any call that takes longer than its timeout
+// The core is then woken up right away and the worker is poisoned: it is never given another call and it is left to finish(if it ever does) on its own
+// The worker works on the arguments that it is given and never on the data memory itself and so a poisoned worker can outlive the VM
+// That way a function that never returns only costs one thread instead of every other library call or the whole VM
+// The pool is bounded and so only so many calls can run at once and only so many workers may be given up on
+
+#include "../../utils/merry_config.h"
+#include "../../utils/merry_types.h"
+#include "../../sys/merry_thread.h"
+#include "../../sys/merry_dynl.h"
+#include "merry_request.h"
+#include "merry_core.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#if defined(_MERRY_HOST_OS_WINDOWS_)
+#include <windows.h>
+#endif
+
+#define _MERRY_CALL_WORKERS_ 4       // the most calls with a timeout that may run at once
+#define _MERRY_CALL_MAX_POISONED_ 16 // the most workers that may be given up on; after that the poisoned ones aren't replaced
+
+// the result of a call with a timeout in Mb
+enum
+{
+    _MERRY_CALL_OK_,        // the function returned
+    _MERRY_CALL_TIMED_OUT_, // the function didn't return in time and Ma is 0
+    _MERRY_CALL_NO_WORKER_, // every worker was busy and so the function wasn't called at all
+};
+
+// a worker's state
+enum
+{
+    _MERRY_CALL_IDLE_,
+    _MERRY_CALL_BUSY_,
+    _MERRY_CALL_FINISHING_, // the function returned and the results are being handed over
+    _MERRY_CALL_POISONED_,
+};
+
+typedef struct MerryCallWorker MerryCallWorker;
+typedef struct MerryCallPool MerryCallPool;
+
+// make the call with the arguments that the pool was given and its result into regs[Ma]
+_MERRY_DEFINE_FUNC_PTR_(void, merry_call_exec_t, dynfunc_t, MerryDynSig *, mptr_t, mqptr_t)
+// done with the arguments; the call returned in time if the second is mtrue and the arguments may be handed back before the core is woken up
+_MERRY_DEFINE_FUNC_PTR_(void, merry_call_release_t, mptr_t, mbool_t)
+// called once the request is fulfilled to hand over the results and wake up the core
+_MERRY_DEFINE_FUNC_PTR_(void, merry_call_done_t, MerryOSRequest *)
+
+struct MerryCallWorker
+{
+    MerryThread *thread;
+    MerryMutex *lock; // only for sleeping and waking up
+    MerryCond *cond;
+    _Atomic mbyte_t state;
+    mbool_t stop;
+    // the call; only the one that moves the worker out of busy may touch these
+    MerryOSRequest request;
+    mqword_t regs[REGR_COUNT]; // the worker works on a copy so that it never touches the core's registers once it is given up on
+    dynfunc_t function;
+    MerryDynSig sig;
+    mptr_t args;
+    mqword_t deadline; // in milliseconds
+    merry_call_exec_t exec;
+    merry_call_release_t release;
+    merry_call_done_t done;
+};
+
+struct MerryCallPool
+{
+    MerryCallWorker *workers[_MERRY_CALL_WORKERS_]; // NULL once a poisoned worker can't be replaced
+    msize_t poisoned;                               // how many were given up on so far
+    MerryThread *watchdog;
+    MerryMutex *lock; // for the workers and the watchdog's sleeping
+    MerryCond *cond;
+    mbool_t stop;
+    merry_call_exec_t exec;
+    merry_call_release_t release;
+    merry_call_done_t done;
+};
+
+MerryCallPool *merry_call_pool_init(merry_call_exec_t exec, merry_call_release_t release, merry_call_done_t done);
+
+// call the function on a free worker and give up on it after timeout milliseconds
+// sig is copied and so it may change right after while args are released by the worker once it is done with them
+// fails if no worker is free in which case args are still the caller's
+mret_t merry_call_pool_call(MerryCallPool *pool, MerryOSRequest *request, dynfunc_t function, MerryDynSig *sig, mptr_t args, msize_t timeout);
+
+// waits for the calls that are handing over their results and gives up on the rest
+void merry_call_pool_destroy(MerryCallPool *pool);
+
+#endif
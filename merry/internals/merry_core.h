@@ -30,10 +30,15 @@
 #include "merry_memory.h"
 #include "merry_dmemory.h"
 #include "merry_opcodes.h"
+#include "merry_request.h"
+#include "services/merry_input.h"
+#include "services/merry_output.h"
+#include "merry_intrinsics.h"
 
 typedef struct MerryCore MerryCore;
 // typedef union MerryRegister MerryRegister;
 typedef struct MerryFlagRegister MerryFlagRegister;
+typedef struct MerryAsyncSlot MerryAsyncSlot;
 
 // #include "merry_exec.h"
 // #include "decoder/merry_decode.h"
@@ -62,6 +67,35 @@ typedef struct MerryFlagRegister MerryFlagRegister;
 #define _MERRY_RAS_LIMIT_ 50           // 50 function calls at max
 #define _MERRY_RAS_GROW_PER_RESIZE_ 10 // 10 new possible function calls per resize
 
+#define _MERRY_CORE_FOREVER_ (~0ULL) // a quantum that never runs out
+
+// why merry_core_run returned
+enum
+{
+    _MERRY_CORE_STOPPED_,   // the core is done for good
+    _MERRY_CORE_BLOCKED_,   // the core made a request and has to wait for it(only for cores run by the scheduler)
+    _MERRY_CORE_PREEMPTED_, // the core ran its quantum of instructions
+};
+
+// where a core run by the scheduler is
+enum
+{
+    _MERRY_CORE_READY_,   // on a run queue
+    _MERRY_CORE_RUNNING_, // on a worker
+    _MERRY_CORE_PARKED_,  // waiting for a request and on no queue
+    _MERRY_CORE_DONE_,    // waiting to be given out again
+    _MERRY_CORE_RETIRED_, // the core's thread is gone for good
+};
+
+// whether a core is blocked in the host(reading the console or in a library function that it calls itself) for as long as that takes
+enum
+{
+    _MERRY_CORE_IN_VM_,
+    _MERRY_CORE_IN_HOST_,
+    _MERRY_CORE_CLOSED_,    // the VM is being destroyed and so the core mustn't go there anymore
+    _MERRY_CORE_ABANDONED_, // the VM was destroyed while the core was there and so its thread must never come back
+};
+
 struct MerryFlagRegister
 {
 #if defined(_MERRY_HOST_CPU_x86_64_ARCH_)
@@ -108,12 +142,22 @@ enum
     REGR_COUNT,
 };
 
+// an asynchronous request that a core has in flight
+// the ticket that the program gets is the index of the slot
+struct MerryAsyncSlot
+{
+    mqword_t regs[REGR_COUNT];         // the registers at the time of the request; the request works on these and not the core's
+    MerryRequestCompletion completion; // shares the core's lock and cond
+    mbool_t in_use;                    // the slot is free once the program collects the ticket with APOLL or AWAIT
+};
+
 struct MerryCore
 {
     // firstly every core shares some variables with other cores
     // they also need some private variables unique to only them
     MerryCond *cond;  // the core's private condition variable
     MerryMutex *lock; // the core's private mutex lock
+    MerryRequestCompletion completion; // where the core waits for its requests to be fulfilled
     // the core's memory
     MerryDMemory *data_mem; // the data memory
     MerryMemory *inst_mem;  // the instruction memory
@@ -137,6 +181,18 @@ struct MerryCore
     // MerryInstruction ir; // the current instruction
     mqword_t current_inst;
     MerryStack *ras; // the RAS
+    MerryAsyncSlot async[_MERRY_ASYNC_SLOTS_]; // the asynchronous requests
+    MerryOutBuffer out; // what the core prints waits here until a whole line is ready
+    // A core is either run on its own thread or by the scheduler
+    // The latter can't wait for a request on the worker's thread and so it leaves the request it waits for in blocked_on and returns to the scheduler
+    mptr_t sched;                         // the scheduler that runs the core(NULL if the core has its own thread)
+    MerryRequestCompletion *blocked_on;   // the request the core is parked on
+    _Atomic mbyte_t run_state;            // where the core is in the scheduler
+    msize_t worker;                       // the worker that ran the core last; the core goes back to its queue when woken up
+    // A core that is done goes on the Manager's free list and is given out again instead of making a new one
+    MerryCore *next_free;
+    mbool_t retired; // the VM is done and so the core's thread shouldn't wait to be given out again
+    _Atomic mbyte_t host;
 };
 
 static _MERRY_ALWAYS_INLINE_ void merry_core_zero_out_reg(MerryCore *core)
@@ -152,6 +208,17 @@ MerryCore *merry_core_init(MerryMemory *inst_mem, MerryDMemory *data_mem, msize_
 
 void merry_core_destroy(MerryCore *core);
 
+// make a core that is done as good as new and point it to start_addr; nothing is allocated and the stack isn't cleared
+void merry_core_reset(MerryCore *core, maddress_t start_addr);
+
+// the VM is being destroyed: stop the core and keep it out of the host from now on
+// Returns mfalse if it is blocked in the host already; nothing waits for it then and nothing that it may still use can be freed
+mbool_t merry_core_close(MerryCore *core);
+
+// run the core until it stops, blocks on a request or has run quantum instructions
+msize_t merry_core_run(MerryCore *core, msize_t quantum);
+
+// the entry of the core's own thread; the thread stays with the core when it is done in case it is given out again
 mptr_t merry_runCore(mptr_t core);
 
 #endif
\ No newline at end of file
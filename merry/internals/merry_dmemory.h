@@ -8,6 +8,7 @@
 #include "../includes/merry_errors.h"
 #include "../../utils/merry_logger.h"
 #include <stdlib.h>
+#include <stdatomic.h>
 
 typedef struct MerryDMemPage MerryDMemPage; // the memory page
 typedef struct MerryDMemory MerryDMemory;   // the memory that manages these pages
@@ -16,6 +17,9 @@ typedef struct MerryDAddress MerryDAddress; // an internal struct
 #define _MERRY_DMEMORY_PGALLOC_MAP_PAGE_ _MERRY_MEM_GET_PAGE_(_MERRY_MEMORY_ADDRESSES_PER_PAGE_, _MERRY_PROT_DEFAULT_, _MERRY_FLAG_DEFAULT_)
 #define _MERRY_DMEMORY_PGALLOC_UNMAP_PAGE_(address) _MERRY_MEM_GIVE_PAGE_(address, _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
 
+// a plain load is enough as a core storing while the page is being mapped is racing with the mapping itself anyway
+#define _MERRY_DMEMORY_READ_ONLY_(page) (atomic_load_explicit(&(page)->read_only, memory_order_relaxed) == mtrue)
+
 #define _MERRY_DMEMORY_DEDUCE_ADDRESS_(addr)                                                                    \
     {                                                                                                           \
         .page = addr / _MERRY_MEMORY_ADDRESSES_PER_PAGE_, .offset = address % _MERRY_MEMORY_ADDRESSES_PER_PAGE_ \
@@ -28,6 +32,7 @@ struct MerryDMemPage
     mdptr_t address_dspace;
     mqptr_t address_qspace;
     MerryMutex *lock;
+    _Atomic mbool_t read_only; // a file is mapped here read-only and so the program can't store to it; the pool changes it while the cores read it
 };
 
 struct MerryDMemory
@@ -78,4 +83,23 @@ mdptr_t merry_dmemory_get_dword_address_bounds(MerryDMemory *memory, maddress_t
 mqptr_t merry_dmemory_get_qword_address(MerryDMemory *memory, maddress_t address);
 mqptr_t merry_dmemory_get_qword_address_bounds(MerryDMemory *memory, maddress_t address, msize_t bound);
 
+// the same as merry_dmemory_get_byte_address_bounds but for the host storing there and so it fails for a read-only page
+mbptr_t merry_dmemory_get_byte_address_store(MerryDMemory *memory, maddress_t address, msize_t bound);
+// the same for merry_dmemory_get_qword_address_bounds
+mqptr_t merry_dmemory_get_qword_address_store(MerryDMemory *memory, maddress_t address, msize_t bound);
+
+// turn [address, address + len) into the host buffers that hold it, one for every page it touches
+// fails if the span leaves the memory or needs more than max buffers(the error is MERRY_INVALID_IOV then)
+// or if the host is going to store into it and it touches a read-only page(the error is MERRY_MEM_READ_ONLY then)
+mret_t merry_dmemory_get_span(MerryDMemory *memory, maddress_t address, msize_t len, mbool_t store, MerryIOVec *iov, msize_t max, msize_t *count);
+
+// map a file over the pages covering [address, address + len) where address must be the start of a page
+// only file_len bytes come from the file starting at offset(a multiple of the host's page size) and the rest of the pages is zeroed
+// The mapping is private and so nothing is written back to the file
+// If it fails part way, the pages it got to are zeroed again as if they were unmapped
+mret_t merry_dmemory_map_file(MerryDMemory *memory, maddress_t address, msize_t len, int fd, mqword_t offset, msize_t file_len, mbool_t read_only);
+
+// replace the pages covering [address, address + len) with zeroed ones
+mret_t merry_dmemory_unmap(MerryDMemory *memory, maddress_t address, msize_t len);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+/*
+ * io_uring file service for the Merry VM
+ * MIT License
+ *
+ * Copyright (c) 2024 MegrajChauhan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _MERRY_FILE_SERVICE_
+#define _MERRY_FILE_SERVICE_
+
+// Fulfills file reads and writes with io_uring
+// The Manager prepares an entry for every read and write it pops and submits all of them together once the request queue is empty
+// The kernel then reads into and writes from the data memory directly and a thread here reaps the completions and wakes up the cores
+// If the host has no io_uring then merry_file_service_init fails and the thread pool fulfills the reads and writes instead
+// If the kernel refuses to take the entries, the Manager takes them back and does them itself so that no core is left waiting
+
+#include "../../utils/merry_config.h"
+#include "../../utils/merry_types.h"
+#include "../../sys/merry_thread.h"
+#include "../../sys/merry_uring.h"
+#include "services/merry_file.h"
+#include "merry_request.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#define _MERRY_FSERV_BATCH_ 32   // submit once this many entries are prepared even if there are more requests to go
+#define _MERRY_FSERV_IOV_MAX_ 8  // the most pages one read or write may touch; the bigger ones are left to the thread pool
+
+typedef struct MerryFileOp MerryFileOp;
+typedef struct MerryFileService MerryFileService;
+
+// called once the request is fulfilled to hand over the results and wake up the core
+_MERRY_DEFINE_FUNC_PTR_(void, merry_fserv_done_t, MerryOSRequest *)
+
+struct MerryFileOp
+{
+    MerryOSRequest request; // the request being fulfilled
+    MerryFile *file;
+    MerryIOVec iov[_MERRY_FSERV_IOV_MAX_]; // the kernel reads these when the entry is submitted and so they must live as long as the op
+    msize_t count;
+    mqword_t offset;  // where in the file
+    msize_t len;
+    mbool_t claimed;  // was the offset claimed from the file's position?
+    _Atomic mbool_t busy;
+};
+
+struct MerryFileService
+{
+    MerryURing *ring;
+    MerryFileOp *ops; // one for every operation in flight
+    msize_t op_count;
+    msize_t next_op; // where to start looking for a free op
+    MerryThread *reaper;
+    merry_fserv_done_t done;
+    _Atomic msize_t in_flight; // the ops that are busy
+    _Atomic mbool_t draining;  // set once destroying and so the reaper says when the last op is done
+    MerryMutex *lock;
+    MerryCond *cond;
+};
+
+// op_count is the most operations that may be in flight at once
+MerryFileService *merry_file_service_init(msize_t op_count, merry_fserv_done_t done);
+
+// prepare the read or write of the buffers at offset(or _MERRY_FILE_CUR_POS_); fails if the service can't take it right now and so it should be fulfilled some other way
+// The file must be held for the op which drops it once it is done
+// Only the Manager may call this and the ones below
+mret_t merry_file_service_prep(MerryFileService *fserv, MerryOSRequest *request, MerryFile *file, MerryIOVec *iov, msize_t count, mqword_t offset);
+
+// submit everything prepared so far; what the kernel doesn't take is done right here before returning
+void merry_file_service_flush(MerryFileService *fserv);
+
+// waits for everything in flight
+void merry_file_service_destroy(MerryFileService *fserv);
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * Intrinsics for the Merry VM
+ * MIT License
+ *
+ * Copyright (c) 2024 MegrajChauhan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _MERRY_INTRINSICS_H_
+#define _MERRY_INTRINSICS_H_
+
+// Small routines that the program calls with the icall instruction
+// They run right on the core's thread and work on the data memory directly without ever going through the Manager
+// Adding one takes a function here and an entry in merry_intrinsics_list.h
+
+#include "../../utils/merry_config.h"
+#include "../../utils/merry_types.h"
+#include "merry_dmemory.h"
+#include "merry_intrinsics_list.h"
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(_MERRY_HOST_OS_WINDOWS_)
+#include <windows.h>
+#endif
+
+#define _MERRY_INTR_STR_LEN_ 512 // the longest string that strtol and strtod will look at
+
+#define _MERRY_INTR_ENUM_(id, name, function) _MERRY_INTR_##id##_,
+enum
+{
+    _MERRY_INTRINSICS_(_MERRY_INTR_ENUM_)
+        _MERRY_INTR_COUNT_, // the number of intrinsics
+};
+#undef _MERRY_INTR_ENUM_
+
+// every intrinsic gets the memory and the core's registers; on failure, the memory's error says what went wrong
+_MERRY_DEFINE_FUNC_PTR_(mret_t, merry_intr_t, MerryDMemory *, mqptr_t)
+
+#define _MERRY_INTR_DECLARE_(id, name, function) mret_t function(MerryDMemory *memory, mqptr_t regs);
+_MERRY_INTRINSICS_(_MERRY_INTR_DECLARE_)
+#undef _MERRY_INTR_DECLARE_
+
+// call the intrinsic at index; fails if there is no such intrinsic or the intrinsic itself fails
+mret_t merry_intrinsic_call(msize_t index, MerryDMemory *memory, mqptr_t regs);
+
+// the name of the intrinsic at index or NULL
+mcstr_t merry_intrinsic_name(msize_t index);
+
+#endif
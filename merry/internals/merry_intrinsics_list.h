@@ -0,0 +1,43 @@
+/*
+ * Intrinsics list for the Merry VM
+ * MIT License
+ *
+ * Copyright (c) 2024 MegrajChauhan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _MERRY_INTRINSICS_LIST_
+#define _MERRY_INTRINSICS_LIST_
+
+// Every intrinsic that the icall instruction can call, in the order of their indices
+// This has no includes so that anything(the Assembler included) can include it and expand the list however it wants
+// X(ID, name, function): ID is used for the index _MERRY_INTR_<ID>_, name is what the program refers to it by and function is what implements it
+// New intrinsics must only ever be appended as the indices are baked into the programs
+// Each one takes its arguments in Mb, Mc and Md and returns its result in Ma
+#define _MERRY_INTRINSICS_(X)                     \
+    X(MEMCPY, memcpy, merry_intr_memcpy)         \
+    X(MEMSET, memset, merry_intr_memset)         \
+    X(MEMCMP, memcmp, merry_intr_memcmp)         \
+    X(STRLEN, strlen, merry_intr_strlen)         \
+    X(STRTOL, strtol, merry_intr_strtol)         \
+    X(STRTOD, strtod, merry_intr_strtod)         \
+    X(CLOCK_MONO, clock_mono, merry_intr_clock_mono) \
+    X(CLOCK_REAL, clock_real, merry_intr_clock_real)
+
+#endif
@@ -263,6 +263,17 @@ enum
   OP_FMUL32,
   OP_FDIV32,
 
+  // asynchronous requests
+  OP_AINTR, // make a request without waiting for it
+  OP_APOLL, // check if an asynchronous request is done
+  OP_AWAIT, // wait for an asynchronous request to be done
+
+  OP_FLUSH, // print whatever the core has buffered right now
+
+  OP_NCALL, // call a function bound with DYNBIND
+
+  OP_ICALL, // call an intrinsic
+
 };
 
 /*
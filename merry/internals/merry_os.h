@@ -31,35 +31,71 @@
 #include "../../utils/merry_types.h"
 #include "merry_reader.h"
 #include "merry_request_hdlr.h"
-// #include "merry_thread_pool.h"
+#include "merry_thread_pool.h"
+#include "merry_file_service.h"
+#include "merry_call_pool.h"
+#include "merry_scheduler.h"
 #include "merry_core.h"
 #include "services/merry_input.h"
 #include "services/merry_output.h"
 #include "../../sys/merry_dynl.h"
+#include "../../sys/merry_topology.h"
 
 typedef struct Merry Merry;
+typedef struct MerryPlacement MerryPlacement;
+
+// where the cores run and where their memory goes
+struct MerryPlacement
+{
+  mbool_t requested;              // if not, the host places everything as it likes
+  msize_t cpus[_MERRY_MAX_CPUS_]; // the cores are pinned to these in turn(core 0 to the first and so on)
+  msize_t cpu_count;              // 0 if the cores aren't pinned to single CPUs
+  mbool_t numa;                   // keep every core on a node(its CPU's or the next node in turn) along with its stack
+  mbool_t interleave;             // spread the data memory over every node instead of leaving it where it was first touched
+  MerryTopology topo;
+};
 
 struct Merry
 {
-  MerryCore **cores;          // the vcores
-  MerryThread **core_threads; // the vcore's threads
-  // MerryThreadPool *thPool;    // the manager's thread pool
+  MerryCore **cores;          // the table of vcores; it has room for max_cores and a core's slot is never given up once claimed
+  MerryThread **core_threads; // the vcore's threads(unused if the scheduler runs them)
+  MerryScheduler *sched;      // runs the vcores on a few workers instead(NULL if every vcore has its own thread)
+  msize_t worker_count;       // how many workers the scheduler gets(0 for no scheduler)
+  MerryThreadPool *thPool;    // the manager's thread pool
+  MerryFileService *fserv;    // file reads and writes go here if the host has io_uring(NULL otherwise)
+  MerryCallPool *callPool;    // calls the library functions that have a timeout
+  MerryPlacement placement;
   MerryMemory *inst_mem;      // the instruction memory that every vcore shares
   MerryDMemory *data_mem;      // the data memory that every vcore shares
   MerryMutex *_lock;          // the Manager's lock
   // MerryMutex *_mem_lock;  // lock for memory read/write
   MerryCond *_cond; // the Manager's cond
   // MerryCond *shared_cond; // this condition is shared among all cores
-  msize_t core_count; // the number of vcores
+  _Atomic msize_t core_count;     // the slots claimed so far(cores and core_threads always have room for max_cores)
+  msize_t max_cores;              // the most cores that a program can have at once
+  _Atomic msize_t active_cores;   // the cores that haven't halted yet; the VM stops once the last one does
+  _Atomic(MerryCore *) free_cores; // the cores that are done and can be given out again(along with their stacks and threads)
   mbool_t stop;       // tell the manager to stop the VM and exit
   msize_t ret;
 };
 
 #include "merry_os_exec.h"
 
-#define _MERRY_REQUEST_QUEUE_LEN_ 10 // for now
+#define _MERRY_MAX_CORES_ 256          // the most cores that a program can have at once unless told otherwise
+#define _MERRY_MAX_CORES_LIMIT_ 16384  // the most that can be asked for
+// Every core has at most one synchronous and _MERRY_ASYNC_SLOTS_ asynchronous requests in flight(panics don't go through the queue)
+// and so with room for that many per core the queue can never overflow
+#define _MERRY_REQUEST_QUEUE_LEN_(max_cores) ((max_cores) * (1 + _MERRY_ASYNC_SLOTS_))
+#define _MERRY_FSERV_MAX_OPS_ 4096   // io_uring doesn't take many more entries than this and the rest can go to the pool
 #define _MERRY_THPOOL_LEN_ 10        // for now
 
+// the keys for the thread pool, requests with the same key are fulfilled in order
+#define _MERRY_KEY_CONSOLE_IN_ 0
+#define _MERRY_KEY_CONSOLE_OUT_ 1
+#define _MERRY_KEY_DYNL_ 2
+#define _MERRY_KEY_MEMMAP_ 3 // mapping files into the data memory and unmapping them
+#define _MERRY_KEY_FIRST_FREE_ 4
+
 #define _MERRY_REQUEST_INTERNAL_ERROR_(request_id) (request_id >= 0 && request_id <= 50)
 #define _MERRY_REQUEST_PROGRAM_ERROR_(request_id) (request_id >= 51 && request_id <= 150)
 #define _MERRY_REQUEST_VALID_(req_id) (req_id >= 151)
@@ -86,12 +122,27 @@ static Merry os;
 // #define merry_manager_mem_read_data(address, store_in) merry_dmemory_read_(os.data_mem, address, store_in)
 // #define merry_manager_mem_write_data(address, _value_to_write) merry_memory_write_lock(os.data_mem, address, _value_to_write)
 
+// must be called before merry_os_init; cpus is the list of CPUs to pin the cores to(NULL to not pin them)
+// fails if the list is malformed or has CPUs that the host doesn't have
+mret_t merry_os_set_placement(mcstr_t cpus, mbool_t numa, mbool_t interleave);
+
+// must be called before merry_os_init; run the cores on count worker threads instead of a thread for every core
+// fails if count is 0 or more than _MERRY_SCHED_MAX_WORKERS_
+mret_t merry_os_set_workers(msize_t count);
+
+// must be called before merry_os_init; fails if count is 0 or more than _MERRY_MAX_CORES_LIMIT_
+mret_t merry_os_set_max_cores(msize_t count);
+
 mret_t merry_os_init(mcstr_t _inp_file);
 mptr_t merry_os_start_vm(mptr_t some_arg);
 
-mret_t merry_os_add_core();
+// get a core for the program: one that is done if there is one or else a new one if there is still room
+mret_t merry_os_add_core(msize_t *core_id);
 mret_t merry_os_boot_core(msize_t core_id, maddress_t start_addr);
 
+// a core that is done hands itself back with this; false if it can't be given out again and so must be left alone
+mbool_t merry_os_core_done(MerryCore *core);
+
 // destroy the OS
 void merry_os_destroy();
 
@@ -39,16 +39,42 @@
                                           : (bits == 5)   ? "a+" \
                                                           : "r"
 
+// call the function in the slot with the arguments in the registers or the data memory and its result into Ma
+// The cores use this for the thread safe functions as well which is why it doesn't need the Manager
+mret_t merry_os_call_slot(MerryDMemory *mem, dynfunc_t function, msize_t slot, mqptr_t regs);
+
+// the same but with the signature given instead of taken from the slot
+mret_t merry_os_call_function(MerryDMemory *mem, dynfunc_t function, MerryDynSig *sig, mqptr_t regs);
+
+// the call pool's side of a call with a timeout: make the call with the arguments that were copied out of the data memory
+// and once it is done, hand back what the function changed in them if it returned in time
+void merry_os_call_copied(dynfunc_t function, MerryDynSig *sig, mptr_t args, mqptr_t regs);
+void merry_os_call_release(mptr_t args, mbool_t returned);
+
 // handle the halt request
 _os_exec_(halt);
 _os_exec_(new_core);
 _os_exec_(dynl);
 _os_exec_(dynul);
 _os_exec_(dyncall);
+_os_exec_(dynbind);
+_os_exec_(ncall);
+_os_exec_(dynsig);
+_os_exec_(dyntimeout);
 _os_exec_(fopen);
 _os_exec_(fclose);
 _os_exec_(fread);
 _os_exec_(fwrite);
 _os_exec_(feof);
+_os_exec_(fpread);
+_os_exec_(fpwrite);
+_os_exec_(fseek);
+_os_exec_(ftell);
+_os_exec_(fsize);
+_os_exec_(freadv);
+_os_exec_(fwritev);
+_os_exec_(fmap);
+_os_exec_(funmap);
+_os_exec_(fcopy);
 
 #endif
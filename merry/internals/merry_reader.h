@@ -29,11 +29,16 @@
 // #include "../lib/include/merry_memory_allocator.h" <LEGACY>
 #include "../../utils/merry_utils.h"
 #include "merry_memory.h"
+#include "../../sys/merry_thread.h" // the pages are loaded by multiple threads
+#include "../lib/include/merry_bswap.h"
+#include "../lib/include/merry_lz4.h"
 #include <stdio.h>  // for FILE
 #include <string.h> // for string manipulation
 #include <stdlib.h> // for conversion from strings to numbers
 
 typedef struct MerryInpFile MerryInpFile;
+typedef struct MerryReaderJob MerryReaderJob;
+typedef struct MerryReaderChunk MerryReaderChunk;
 
 #define _READ_ERROR_(fmt, ...) fprintf(stderr, fmt, __VA_ARGS__)
 #define _READ_DIRERROR_(message, ...) fprintf(stderr, message, ##__VA_ARGS__)
@@ -41,6 +46,15 @@ typedef struct MerryInpFile MerryInpFile;
 #define _INP_FILE_ORDERING_BIG_ _MERRY_BIG_ENDIAN_
 
 #define _READER_HEADER_LEN_ 32
+#define _READER_MAX_THREADS_ 16 // the maximum number of threads that will load the pages
+
+// the 4th byte of the header holds the flags
+#define _READER_FLAGS_BYTE_ 3
+#define _READER_FLAG_NATIVE_LE_ 0x01 // the instructions and data are in little endian no matter what merry is configured with
+#define _READER_FLAG_COMPRESSED_ 0x02 // every page is compressed independently
+#define _READER_FLAG_BSS_ 0x04        // the data section is followed by zero-filled bytes that aren't in the file
+#define _READER_KNOWN_FLAGS_ (_READER_FLAG_NATIVE_LE_ | _READER_FLAG_COMPRESSED_ | _READER_FLAG_BSS_)
+#define _READER_EXT_FLAGS_ (_READER_FLAG_COMPRESSED_ | _READER_FLAG_BSS_) // the flags that need the extended header
 // #define _READER_GET_SIGNATURE_(header) (header >> 40)
 // #define _READER_GET_SDT_OFF_(header) header & 0xFFFFFFFF
 // #define _READER_GET_BYTE_ORDER_(header) (header >> 32) & 0x1
@@ -67,10 +81,15 @@ struct MerryInpFile
     msize_t file_len; // the number of bytes in the file
     FILE *f;          // the opened file
     // the metadata representation
-    msize_t byte_order;
+    msize_t byte_order; // the byte ordering of the instructions and data in the file
+    mbyte_t flags;      // the flags from the header
     msize_t dlen; // data bytes len
     msize_t ilen; // the instruction bytes len
     msize_t slen; // the string len
+    msize_t bsslen; // the zero-filled bytes after the strings
+    mbool_t invert; // do the bytes need to be inverted?
+    msize_t ext_len; // the length of the extended header(0 if there is none)
+    MerryReaderChunk *chunks; // for compressed files, where every page is in the file
     // the file results
     msize_t ipage_count;
     msize_t dpage_count;
@@ -78,6 +97,25 @@ struct MerryInpFile
     mqptr_t *_instructions; // the read instructions
 };
 
+// In compressed files, every page is stored as a chunk of its own
+// A chunk that is as long as the page it belongs to is stored as is
+struct MerryReaderChunk
+{
+    msize_t offset; // where the chunk starts in the file
+    msize_t len;    // the compressed length
+};
+
+// every loader thread gets a range of pages to read and convert
+// the instruction pages are numbered first and then the data pages
+struct MerryReaderJob
+{
+    MerryInpFile *inp;
+    msize_t start; // the first page to load
+    msize_t end;   // one past the last page to load
+    mret_t ret;    // did the job succeed?
+    mbptr_t scratch; // the compressed chunks are read here before being decompressed
+};
+
 MerryInpFile *merry_read_file(mcstr_t _file_name);
 
 void merry_destory_reader(MerryInpFile *inp);
@@ -30,8 +30,14 @@
 #include "../../utils/merry_config.h"
 #include "../../utils/merry_types.h"
 #include "../../sys/merry_thread.h"
+#include <stdatomic.h>
 
 typedef struct MerryOSRequest MerryOSRequest;
+struct MerryFile;
+typedef struct MerryRequestCompletion MerryRequestCompletion;
+
+// called once the request is done for a core that isn't sleeping on its cond
+_MERRY_DEFINE_FUNC_PTR_(void, merry_wake_t, mptr_t)
 /*
  Each service that the OS provides has a Number and this request struct holds that number.
  When a core posts a request, it will have to stop execution totally and wait for it's request to be fulfilled.
@@ -39,13 +45,36 @@ typedef struct MerryOSRequest MerryOSRequest;
  inefficiency is the key.
 */
 
+// Every core has one of these and since a core can only have one request in flight, it is never shared
+// The manager sets done after fulfilling the request and the core only sleeps on its own cond if it isn't done yet
+struct MerryRequestCompletion
+{
+    _Atomic mbool_t done;
+    MerryMutex *lock; // the requesting core's lock
+    MerryCond *cond;  // the requesting core's condition variable
+    merry_wake_t wake; // for cores run by the scheduler which are parked instead(NULL otherwise)
+    mptr_t waiter;     // what wake is called with
+};
+
 struct MerryOSRequest
 {
-    msize_t request_number; // this is like the interrupt number
-    MerryCond *_wait_lock;  // the requesting core's condition variable
-    msize_t id;             // the core's id
+    msize_t request_number;             // this is like the interrupt number
+    MerryRequestCompletion *completion; // where the requesting core waits for the request to be fulfilled(NULL for panics)
+    msize_t id;                         // the core's id
+    mqptr_t regs;                       // the registers the request reads its arguments from and writes its results to
+    mqptr_t result;                     // for asynchronous requests, the descriptor in the data memory that the results are written to(NULL otherwise)
+    struct MerryFile *file;             // the file that the request holds until it is fulfilled(NULL if it isn't on a file)
 };
 
+// Asynchronous requests
+// A core can have this many asynchronous requests in flight on top of the synchronous one
+#define _MERRY_ASYNC_SLOTS_ 4
+// The layout of the descriptor, every field is a qword
+#define _MERRY_ASYNC_DESC_STATUS_ 0 // 0 while pending, 1 once fulfilled
+#define _MERRY_ASYNC_DESC_MA_ 1     // the value of Ma after the request
+#define _MERRY_ASYNC_DESC_MB_ 2     // the value of Mb after the request
+#define _MERRY_ASYNC_DESC_LEN_ 3
+
 enum
 {
     // these error value ranges will change with time
@@ -65,7 +94,23 @@ enum
     _REQ_FREAD,         // read from a file
     _REQ_FWRITE,        // write to a file
     _REQ_FEOF,          // has the EOF been reached?
-    // other functions like fseek, ftell, rewind can be implemented using the above as the base in software
+    _REQ_FPREAD,        // read from a file at an offset without moving the file's position
+    _REQ_FPWRITE,       // write to a file at an offset without moving the file's position
+    _REQ_FSEEK,         // move the file's position
+    _REQ_FTELL,         // get the file's position
+    _REQ_FSIZE,         // get the file's size
+    _REQ_FREADV,        // read from a file into many buffers at once
+    _REQ_FWRITEV,       // write to a file from many buffers at once
+    _REQ_FMAP,          // map a file into the data memory
+    _REQ_FUNMAP,        // remove a file mapped into the data memory
+    _REQ_FCOPY,         // copy from one file to another
+    _REQ_DYNBIND,       // look up a function in a dynamically loaded library once and get a slot for it
+    _REQ_NCALL,         // call the function bound to a slot
+    _REQ_DYNSIG,        // give the function bound to a slot a signature so that it can be called with typed arguments
+    _REQ_DYNTIMEOUT,    // give the function bound to a slot a timeout after which the call is given up on
 };
 
+// the requests that change the VM's state can't be made asynchronously
+#define _MERRY_REQUEST_ASYNC_OK_(req_id) (req_id >= _REQ_READCHAR)
+
 #endif
\ No newline at end of file
@@ -32,12 +32,18 @@
 
 typedef struct MerryRequestHdlr MerryRequestHdlr;
 
+#define _MERRY_REQUEST_SPIN_COUNT_ 1024 // how many times a core checks if its request is done before going to sleep
+
 struct MerryRequestHdlr
 {
-    MerryRequestQueue *queue; // the request queue
-    MerryMutex *lock;         // only one thread can pop and push
-    MerryCond *host_cond;     // the OS's condition variable
-    mbool_t handle_more;      // a flag to see if the handler should accept more request
+    MerryRequestQueue *queue;       // the request queue
+    MerryMutex *lock;               // only used by the manager to go to sleep and by the cores to wake it up
+    MerryCond *host_cond;           // the OS's condition variable
+    _Atomic mbool_t handle_more;    // a flag to see if the handler should accept more request
+    _Atomic mbool_t host_sleeping;  // is the manager sleeping(or about to)?
+    _Atomic mbool_t panicking;      // set once panic_error is ready for the manager
+    merrot_t panic_error;           // the error the first panic was for(the rest are ignored)
+    mbool_t panic_taken;            // has the manager popped the panic yet?
 };
 
 // the request handler doesn't belong to even the OS just like Reader
@@ -45,11 +51,25 @@ static MerryRequestHdlr req_hdlr;
 
 mret_t merry_requestHdlr_init(msize_t queue_len, MerryCond *cond);
 
-mret_t merry_requestHdlr_push_request(msize_t req_id, msize_t id, MerryCond *req_cond);
+// push a request and wait until the manager fulfills it
+mret_t merry_requestHdlr_push_request(msize_t req_id, msize_t id, MerryRequestCompletion *completion, mqptr_t regs);
+
+// push a request but don't wait for it
+// the results are written to result and the completion is set once done
+mret_t merry_requestHdlr_push_async(msize_t req_id, msize_t id, MerryRequestCompletion *completion, mqptr_t regs, mqptr_t result);
+
+// wait until the request that the completion belongs to is fulfilled
+void merry_requestHdlr_await(MerryRequestCompletion *completion);
 
 // exclusive for the OS
 mbool_t merry_requestHdlr_pop_request(MerryOSRequest *request);
 
+// exclusive for the OS: sleep until there is something to pop
+void merry_requestHdlr_wait();
+
+// exclusive for the OS: wake up the core that made the request
+void merry_requestHdlr_complete(MerryOSRequest *request);
+
 // exclusive for cores to inform the OS of errors quickly
 void merry_requestHdlr_panic(merrot_t error);
 
@@ -25,34 +25,41 @@
 #ifndef _MERRY_OS_QUEUE_
 #define _MERRY_OS_QUEUE_
 
-#include "../lib/include/merry_queue.h"
+// The request queue is a bounded ring buffer that the cores push into without any locks and only the manager pops from
+// Every slot has a sequence number that tells both sides whose turn it is on that slot(Dmitry Vyukov's bounded queue)
+// The slots are a cache line each so that cores pushing into neighbouring slots don't keep stealing the line from each other
+
 #include "merry_request.h"
+#include <stdlib.h>
+
+#define _MERRY_CACHE_LINE_LEN_ 64
 
-typedef struct MerryRequestNode MerryRequestNode;
+typedef struct MerryRequestSlot MerryRequestSlot;
 typedef struct MerryRequestQueue MerryRequestQueue;
 
-_MERRY_CREATE_QUEUE_NODE_NOPTR_(MerryOSRequest, MerryRequestNode)
+struct MerryRequestSlot
+{
+    _Alignas(_MERRY_CACHE_LINE_LEN_) _Atomic msize_t seq; // == position: free for the producer at position, == position + 1: ready for the consumer
+    MerryOSRequest request;
+};
 
-_MERRY_CREATE_QUEUE_NOPTR_(MerryRequestQueue, MerryRequestNode)
+struct MerryRequestQueue
+{
+    MerryRequestSlot *slots;
+    msize_t mask; // the capacity is always a power of 2
+    _Alignas(_MERRY_CACHE_LINE_LEN_) _Atomic msize_t head; // the next position to push into, shared by every core
+    _Alignas(_MERRY_CACHE_LINE_LEN_) msize_t tail;         // the next position to pop from, only the manager touches it
+};
 
 MerryRequestQueue *merry_request_queue_init(msize_t number_of_requests);
 
-static _MERRY_ALWAYS_INLINE_ mbool_t merry_is_queue_full(MerryRequestQueue *queue)
-{
-    return _MERRY_IS_QUEUE_FULL_NOPTR_(queue) ? mtrue : mfalse;
-}
-
-static _MERRY_ALWAYS_INLINE_ mbool_t merry_is_queue_emtpy(MerryRequestQueue *queue)
-{
-    return _MERRY_IS_QUEUE_EMPTY_NOPTR_(queue) ? mtrue : mfalse;
-}
+mbool_t merry_is_queue_emtpy(MerryRequestQueue *queue);
 
 void merry_request_queue_destroy(MerryRequestQueue *queue);
 
-mbool_t merry_push_request(MerryRequestQueue *queue, MerryCond *_req_cond, msize_t req_num, msize_t id);
+mbool_t merry_push_request(MerryRequestQueue *queue, MerryOSRequest *request);
 
+// only one thread may pop at a time
 mbool_t merry_pop_request(MerryRequestQueue *queue, MerryOSRequest *dest);
 
-void merry_panic_push(MerryRequestQueue *queue, merrot_t error);
-
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,91 @@
+/*
+ * Core scheduler for the Merry VM
+ * MIT License
+ *
+ * Copyright (c) 2024 MegrajChauhan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _MERRY_SCHEDULER_
+#define _MERRY_SCHEDULER_
+
+// Runs the cores on a fixed number of worker threads instead of giving every core a thread of its own
+// Every worker has a run queue of its own and a worker that runs out of cores steals from the others
+// A core runs for a quantum of instructions and then goes to the back of the queue so that one busy core can't starve the others
+// A core that makes a request is parked instead of waiting for it and so it costs no thread at all until the request is done
+// It is then put back on the queue of the worker that ran it last
+
+#include "../../utils/merry_config.h"
+#include "../../utils/merry_types.h"
+#include "../../sys/merry_thread.h"
+#include "merry_request.h"
+#include "merry_core.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#define _MERRY_SCHED_QUANTUM_ 10000   // the instructions that a core runs before the others get a turn
+#define _MERRY_SCHED_MAX_WORKERS_ 256 // the most workers there can be
+
+typedef struct MerrySchedWorker MerrySchedWorker;
+typedef struct MerryScheduler MerryScheduler;
+
+// called with every core that is done so that it may be given out again
+_MERRY_DEFINE_FUNC_PTR_(mbool_t, merry_sched_done_t, MerryCore *)
+
+struct MerrySchedWorker
+{
+    MerryThread *thread;
+    MerryMutex *lock;  // for the queue; the worker takes from the front and the others steal from the back
+    MerryCore **queue; // a ring with room for every core as a core is on one queue at most
+    msize_t head, count;
+    msize_t id;
+    MerryScheduler *sched;
+    mbool_t abandoned; // its core is blocked in the host and so nothing waits for it
+};
+
+struct MerryScheduler
+{
+    MerrySchedWorker *workers;
+    msize_t worker_count;
+    msize_t queue_len;
+    MerryMutex *lock; // only for sleeping and waking up
+    MerryCond *cond;  // the idle workers sleep here
+    _Atomic msize_t ready;    // the cores on all of the queues
+    _Atomic msize_t sleeping; // the workers that are sleeping
+    _Atomic mbool_t stop;
+    merry_sched_done_t done;
+};
+
+// queue_len is the most cores there may be
+MerryScheduler *merry_sched_init(msize_t worker_count, msize_t queue_len, merry_sched_done_t done);
+
+// start running the core on one of the workers; the scheduler runs it until it stops
+// a core that is done may be added again once it is reset
+void merry_sched_add(MerryScheduler *sched, MerryCore *core);
+
+// the worker's core was given up on(see merry_core_close) and so stopping doesn't wait for it
+void merry_sched_abandon(MerryScheduler *sched, msize_t worker);
+
+// stop the workers once they are done with the cores they are running; the cores on the queues and the parked ones are left as they are
+void merry_sched_stop(MerryScheduler *sched);
+
+// only after merry_sched_stop and once nothing can wake up a core anymore
+void merry_sched_destroy(MerryScheduler *sched);
+
+#endif
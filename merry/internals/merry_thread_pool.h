@@ -0,0 +1,73 @@
+/*
+ * Thread pool for the Merry VM's services
+ * MIT License
+ *
+ * Copyright (c) 2024 MegrajChauhan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _MERRY_THREAD_POOL_
+#define _MERRY_THREAD_POOL_
+
+// Represents a thread pool usable by the OS for some services
+// Every thread in the pool has a queue of its own and the requests are routed to a thread based on a key
+// Requests with the same key always go to the same thread and so they are fulfilled in the order they came in while requests with different keys
+// can be fulfilled simultaneously(one core's slow file read doesn't stall another core writing to the console)
+
+#include "../../utils/merry_types.h"
+#include "../../sys/merry_thread.h"
+#include "merry_request_queue.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+
+typedef struct MerryThreadPoolThread MerryThreadPoolThread;
+typedef struct MerryThreadPool MerryThreadPool;
+
+// the function that fulfills a request; it is also responsible for waking up the requesting core
+_MERRY_DEFINE_FUNC_PTR_(void, merry_thPool_exec_t, MerryOSRequest *)
+
+struct MerryThreadPoolThread
+{
+    MerryThread *thread;
+    MerryRequestQueue *queue;  // the requests assigned to this thread
+    MerryMutex *lock;          // only for sleeping and waking up
+    MerryCond *cond;           // the thread sleeps on this when it has nothing to do
+    _Atomic mbool_t sleeping;  // is the thread sleeping(or about to)?
+    _Atomic mbool_t stop;      // tell the thread to stop
+    mbool_t _is_init;          // is the thread running?
+    merry_thPool_exec_t exec;  // the pool's exec function
+};
+
+struct MerryThreadPool
+{
+    MerryThreadPoolThread *threads; // the pool of the threads
+    msize_t pool_size;              // the pool's size
+};
+
+// queue_len is the most requests that can be assigned to a single thread at once
+MerryThreadPool *merry_init_thread_pool(msize_t pool_size, msize_t queue_len, merry_thPool_exec_t exec);
+
+// give the request to the thread that the key belongs to
+// Only one thread may assign requests at a time
+mret_t merry_thPool_assign(MerryThreadPool *pool, msize_t key, MerryOSRequest *request);
+
+// stops every thread after it is done with what it was assigned
+void merry_destroy_thread_pool(MerryThreadPool *pool);
+
+#endif
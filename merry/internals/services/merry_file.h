@@ -0,0 +1,130 @@
+/*
+ * File service for the Merry VM
+ * MIT License
+ *
+ * Copyright (c) 2024 MegrajChauhan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _MERRY_FILE_
+#define _MERRY_FILE_
+
+// The files opened by the program
+// The program only ever sees a small handle that indexes into a table here and never a host pointer
+// Every read and write is positional with the position kept here which is what allows many of them to be in flight at once
+
+#include "../../../utils/merry_config.h"
+#include "../../../utils/merry_types.h"
+#include "../../../sys/merry_thread.h"
+#include "../../../sys/merry_mem.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+
+#if defined(_MERRY_HOST_OS_LINUX_)
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+#include <io.h>
+#endif
+
+#define _MERRY_MAX_FILES_ 1024   // the most files that can be open at once
+#define _MERRY_FILE_IOV_MAX_ 1024 // the most buffers a vectored read or write can take
+#define _MERRY_FILE_CUR_POS_ (~0ULL) // read or write at the file's position and move it instead of using an offset
+#define _MERRY_FILE_COPY_BUF_LEN_ 65536 // the buffer for copying when the host can't do it by itself
+
+enum
+{
+    _MERRY_FILE_SEEK_SET_,
+    _MERRY_FILE_SEEK_CUR_,
+    _MERRY_FILE_SEEK_END_,
+};
+
+
+typedef struct MerryFile MerryFile;
+typedef struct MerryFileTable MerryFileTable;
+
+struct MerryFile
+{
+    int fd;
+    _Atomic mqword_t pos; // where the next read or write goes
+    _Atomic mbool_t eof;  // a read came up short
+    _Atomic msize_t refs;   // the handle itself and every request still using the descriptor; the last one to go closes it
+    _Atomic msize_t queued; // reads and writes the file service has yet to finish
+    mbool_t closing;        // closed by the program but still in use and so the handle can't be used or given out again yet
+    mbool_t in_use;
+};
+
+struct MerryFileTable
+{
+    MerryFile files[_MERRY_MAX_FILES_];
+    MerryMutex *lock; // for opening and closing and taking and dropping references
+    MerryCond *cond;  // signalled when a file has nothing left in the file service
+};
+
+mret_t merry_file_table_init();
+
+// closes whatever the program left open
+void merry_file_table_destroy();
+
+// mode is the same as the one for FOPEN; returns the handle or 0 on failure
+mqword_t merry_file_open(mcstr_t name, mqword_t mode);
+
+// the descriptor is closed once everything holding the file drops it
+mret_t merry_file_close(mqword_t handle);
+
+// NULL if the handle doesn't belong to an open file
+MerryFile *merry_file_get(mqword_t handle);
+
+// the same but the file is held until merry_file_drop and so closing it can't take the descriptor away
+// refs is what the file was held by before this which is 1 when nothing but the handle itself holds it
+MerryFile *merry_file_hold(mqword_t handle, msize_t *refs);
+
+void merry_file_drop(MerryFile *file);
+
+// the file service has a read or write on the file that it hasn't finished yet
+void merry_file_queue(MerryFile *file);
+
+void merry_file_dequeue(MerryFile *file);
+
+// wait for the file service to finish everything queued on the file
+void merry_file_wait_queue(MerryFile *file);
+
+// claim len bytes at the file's current position; the position is moved past them and their offset is returned
+#define merry_file_claim(file, len) atomic_fetch_add(&(file)->pos, len)
+
+// give back what a short read or write didn't use if nothing was claimed after it; a short read means the end of the file was reached
+void merry_file_settle(MerryFile *file, mqword_t offset, msize_t len, msize_t done, mbool_t is_read);
+
+// synchronous read and write of the buffers in order at offset(or _MERRY_FILE_CUR_POS_); they return the number of bytes that went through
+msize_t merry_file_read(MerryFile *file, MerryIOVec *iov, msize_t count, mqword_t offset);
+msize_t merry_file_write(MerryFile *file, MerryIOVec *iov, msize_t count, mqword_t offset);
+
+// copy len bytes from one file to another at their positions without them ever leaving the host's kernel if possible
+// returns the number of bytes copied
+msize_t merry_file_copy(MerryFile *to, MerryFile *from, msize_t len);
+
+// move the file's position which also clears the EOF
+mret_t merry_file_seek(MerryFile *file, msqword_t offset, mqword_t whence, mqptr_t new_pos);
+
+mret_t merry_file_size(MerryFile *file, mqptr_t size);
+
+#endif
@@ -2,16 +2,64 @@
 #define _MERRY_INPUT_
 
 #include "../../../utils/merry_types.h"
+#include "../../../utils/merry_config.h"
+#include "../../../sys/merry_thread.h"
 // // #include <string.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "../merry_dmemory.h"
 
+#if defined(_MERRY_HOST_OS_LINUX_)
+#include <unistd.h>
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+#include <io.h>
+#endif
+
 // #define _MERRY_BASE_LEN_ 32
 
+#define _MERRY_IN_BUF_LEN_ 65536 // how much is read from the console at once
+#define _MERRY_IN_DIGITS_MAX_ 800 // more significant digits than a double can ever need to be rounded correctly
+
+// Everything the program reads from the console goes through here and not through stdio
+// Input is read in big blocks and the numbers are parsed straight out of the block which is much faster than scanf
+// Nothing else may read stdin once this is in use as whatever is in the block would be lost to it
+typedef struct MerryInReader MerryInReader;
+
+struct MerryInReader
+{
+    MerryMutex *lock; // the cores and the pool threads all read from the same console
+    msize_t pos, len; // what is left of the block
+    mbool_t eof;      // once the console ends it stays ended
+    char buf[_MERRY_IN_BUF_LEN_];
+};
+
+mret_t merry_in_init();
+
+void merry_in_destroy();
+
 // the simplest one
 mret_t merry_read_char(MerryDMemory *mem, maddress_t address); // _store_in is an address in the data_mem that the manager will provide
 
+// one byte or -1 once the console has ended
+msqword_t merry_in_char();
+
+// fill len bytes; once the console ends every byte left is 0xFF
+void merry_in_bytes(mbptr_t to, msize_t len);
+
+// Numbers
+// Whitespace before the number is skipped and the number ends at the first character that can't be a part of it which is left unread
+// If there is no number(the console ended or the first character can't start one) then they fail and value is left alone
+// Integers may have a sign and wrap around if they are too big; with any_base, a 0x prefix means hexadecimal and a leading 0 octal
+mret_t merry_in_integer(mqptr_t value, mbool_t any_base);
+
+// decimal only with an optional fraction and exponent or inf, infinity and nan; the result is correctly rounded
+mret_t merry_in_double(double *value);
+
+// the same but rounded to a float once
+mret_t merry_in_float(float *value);
+
 // // implementing the above is all that is needed
 // // reading integers and strings can be implemented with the above as the base
 
@@ -27,4 +75,4 @@ mret_t merry_read_char(MerryDMemory *mem, maddress_t address); // _store_in is a
 // // this is going to read a number of 8 bytes long
 // void merry_read_qword(mptr_t _store_in);
 
-#endif
\ No newline at end of file
+#endif
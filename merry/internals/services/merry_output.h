@@ -2,11 +2,48 @@
 #define _MERRY_OUTPUT_
 
 #include "../../../utils/merry_types.h"
+#include "../../../utils/merry_config.h"
 #include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
 #include "../merry_dmemory.h"
 
+#define _MERRY_OUT_BUF_LEN_ 4096 // every core's console output buffer
+
+// Every core collects what it prints here and hands it to stdout in one go
+// This way stdout's lock is taken once per line or per full buffer instead of once for every byte
+// The core flushes it before every request and every read from the console so that the output is in the same order as it would have been without it
+typedef struct MerryOutBuffer MerryOutBuffer;
+
+struct MerryOutBuffer
+{
+    msize_t len; // bytes waiting to be written
+    char buf[_MERRY_OUT_BUF_LEN_];
+};
+
 mret_t merry_write_char(MerryDMemory *mem, maddress_t address);
 
+// write everything in the buffer to stdout
+void merry_out_flush(MerryOutBuffer *out);
+
+// write len bytes straight to stdout after whatever is in the buffer
+void merry_out_write(MerryOutBuffer *out, mbptr_t bytes, msize_t len);
+
+// same as fprintf(stdout, ...)
+void merry_out_format(MerryOutBuffer *out, mcstr_t format, ...);
+
+// These print exactly what fprintf would for "%lld", "%llu" and "%f" but without parsing a format or looking at the locale
+void merry_out_signed(MerryOutBuffer *out, msqword_t value);
+void merry_out_unsigned(MerryOutBuffer *out, mqword_t value);
+void merry_out_double(MerryOutBuffer *out, double value);
+
+static inline void merry_out_byte(MerryOutBuffer *out, char byte)
+{
+    out->buf[out->len++] = byte;
+    if (byte == '\n' || out->len == _MERRY_OUT_BUF_LEN_)
+        merry_out_flush(out);
+}
+
 // void merry_write_word(mptr_t _to_write);
 
 // void merry_write_dword(mptr_t _to_write);
@@ -15,4 +52,4 @@ mret_t merry_write_char(MerryDMemory *mem, maddress_t address);
 
 // void merry_write_bytes(mptr_t _to_write, msize_t _len);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,343 @@
+#include "../merry_file.h"
+
+// the flags every file is opened with on top of its mode
+#if defined(_MERRY_HOST_OS_LINUX_)
+#define _MERRY_FILE_OPEN_FLAGS_ O_CLOEXEC
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+#define open _open
+#define close _close
+#define _MERRY_FILE_OPEN_FLAGS_ (_O_BINARY | _O_NOINHERIT) // files are opened in text mode otherwise which changes the bytes read and written
+#endif
+
+_MERRY_INTERNAL_ MerryFileTable file_table;
+
+_MERRY_INTERNAL_ int merry_file_flags(mqword_t mode)
+{
+    // the same modes as fopen's
+    switch (mode)
+    {
+    case 1: // r+
+        return O_RDWR;
+    case 2: // w
+        return O_WRONLY | O_CREAT | O_TRUNC;
+    case 3: // w+
+        return O_RDWR | O_CREAT | O_TRUNC;
+    case 4: // a
+        return O_WRONLY | O_CREAT | O_APPEND;
+    case 5: // a+
+        return O_RDWR | O_CREAT | O_APPEND;
+    }
+    return O_RDONLY; // r
+}
+
+mret_t merry_file_table_init()
+{
+    for (msize_t i = 0; i < _MERRY_MAX_FILES_; i++)
+    {
+        file_table.files[i].in_use = mfalse;
+        atomic_init(&file_table.files[i].pos, 0);
+        atomic_init(&file_table.files[i].eof, mfalse);
+        atomic_init(&file_table.files[i].refs, 0);
+        atomic_init(&file_table.files[i].queued, 0);
+        file_table.files[i].closing = mfalse;
+    }
+    if ((file_table.lock = merry_mutex_init()) == RET_NULL)
+        return RET_FAILURE;
+    if ((file_table.cond = merry_cond_init()) == RET_NULL)
+    {
+        merry_mutex_destroy(file_table.lock);
+        return RET_FAILURE;
+    }
+    return RET_SUCCESS;
+}
+
+void merry_file_table_destroy()
+{
+    for (msize_t i = 0; i < _MERRY_MAX_FILES_; i++)
+    {
+        if (file_table.files[i].in_use == mtrue)
+            close(file_table.files[i].fd);
+        file_table.files[i].in_use = mfalse;
+    }
+    merry_mutex_destroy(file_table.lock);
+    merry_cond_destroy(file_table.cond);
+}
+
+mqword_t merry_file_open(mcstr_t name, mqword_t mode)
+{
+    int fd = open(name, merry_file_flags(mode) | _MERRY_FILE_OPEN_FLAGS_, 0666);
+    if (fd < 0)
+        return 0;
+    merry_mutex_lock(file_table.lock);
+    for (msize_t i = 0; i < _MERRY_MAX_FILES_; i++)
+    {
+        MerryFile *file = &file_table.files[i];
+        if (file->in_use == mtrue)
+            continue;
+        file->fd = fd;
+        atomic_store(&file->pos, 0);
+        atomic_store(&file->eof, mfalse);
+        atomic_store(&file->refs, 1); // the handle
+        atomic_store(&file->queued, 0);
+        file->closing = mfalse;
+        file->in_use = mtrue;
+        merry_mutex_unlock(file_table.lock);
+        return i + 1; // 0 is never a valid handle
+    }
+    merry_mutex_unlock(file_table.lock);
+    close(fd); // too many files open
+    return 0;
+}
+
+_MERRY_INTERNAL_ void merry_file_release(MerryFile *file)
+{
+    // the lock is held
+    if (atomic_fetch_sub(&file->refs, 1) != 1)
+        return;
+    // nothing is using the descriptor anymore and so the number can be given out again
+    close(file->fd);
+    file->in_use = mfalse;
+}
+
+mret_t merry_file_close(mqword_t handle)
+{
+    merry_mutex_lock(file_table.lock);
+    MerryFile *file = merry_file_get(handle);
+    if (file == RET_NULL)
+    {
+        merry_mutex_unlock(file_table.lock);
+        return RET_FAILURE;
+    }
+    // the requests still holding it see the handle as closed but the descriptor stays open until they are done
+    file->closing = mtrue;
+    merry_file_release(file);
+    merry_mutex_unlock(file_table.lock);
+    return RET_SUCCESS;
+}
+
+MerryFile *merry_file_get(mqword_t handle)
+{
+    if (handle == 0 || handle > _MERRY_MAX_FILES_ || file_table.files[handle - 1].in_use == mfalse || file_table.files[handle - 1].closing == mtrue)
+        return RET_NULL;
+    return &file_table.files[handle - 1];
+}
+
+MerryFile *merry_file_hold(mqword_t handle, msize_t *refs)
+{
+    merry_mutex_lock(file_table.lock);
+    MerryFile *file = merry_file_get(handle);
+    if (file != RET_NULL)
+        *refs = atomic_fetch_add(&file->refs, 1);
+    merry_mutex_unlock(file_table.lock);
+    return file;
+}
+
+void merry_file_drop(MerryFile *file)
+{
+    merry_mutex_lock(file_table.lock);
+    merry_file_release(file);
+    merry_mutex_unlock(file_table.lock);
+}
+
+void merry_file_queue(MerryFile *file)
+{
+    atomic_fetch_add(&file->queued, 1);
+}
+
+void merry_file_dequeue(MerryFile *file)
+{
+    if (atomic_fetch_sub(&file->queued, 1) != 1)
+        return;
+    merry_mutex_lock(file_table.lock);
+    merry_cond_broadcast(file_table.cond);
+    merry_mutex_unlock(file_table.lock);
+}
+
+void merry_file_wait_queue(MerryFile *file)
+{
+    if (atomic_load(&file->queued) == 0)
+        return;
+    merry_mutex_lock(file_table.lock);
+    while (atomic_load(&file->queued) > 0)
+        merry_cond_wait(file_table.cond, file_table.lock);
+    merry_mutex_unlock(file_table.lock);
+}
+
+void merry_file_settle(MerryFile *file, mqword_t offset, msize_t len, msize_t done, mbool_t is_read)
+{
+    if (done == len)
+        return;
+    mqword_t expected = offset + len;
+    atomic_compare_exchange_strong(&file->pos, &expected, offset + done);
+    if (is_read == mtrue)
+        atomic_store(&file->eof, mtrue);
+}
+
+_MERRY_INTERNAL_ msize_t merry_file_iov_len(MerryIOVec *iov, msize_t count)
+{
+    msize_t len = 0;
+    for (msize_t i = 0; i < count; i++)
+        len += iov[i].iov_len;
+    return len;
+}
+
+#if defined(_MERRY_HOST_OS_LINUX_)
+_MERRY_INTERNAL_ msize_t merry_file_rw(MerryFile *file, MerryIOVec *iov, msize_t count, mqword_t offset, mbool_t is_read)
+{
+    // one host call no matter how many buffers there are
+    msize_t len = merry_file_iov_len(iov, count);
+    mbool_t claimed = offset == _MERRY_FILE_CUR_POS_;
+    if (claimed == mtrue)
+        offset = merry_file_claim(file, len);
+    ssize_t done = (is_read == mtrue) ? preadv(file->fd, iov, (int)count, offset) : pwritev(file->fd, iov, (int)count, offset);
+    if (done < 0)
+        done = 0;
+    if (claimed == mtrue)
+        merry_file_settle(file, offset, len, done, is_read);
+    return done;
+}
+
+_MERRY_INTERNAL_ msize_t merry_file_copy_in_kernel(MerryFile *to, MerryFile *from, mqword_t in_off, mqword_t out_off, msize_t len)
+{
+    // try copy_file_range first which may not even have to copy anything(reflinks) and then sendfile
+    // they fail if the host can't copy these files that way and return 0 once the source ends
+    msize_t done = 0;
+    loff_t in = in_off, out = out_off;
+    while (done < len)
+    {
+        ssize_t res = syscall(__NR_copy_file_range, from->fd, &in, to->fd, &out, len - done, 0);
+        if (res == 0)
+            return done;
+        if (res < 0)
+            break;
+        done += res;
+    }
+    if (done == len)
+        return done;
+    // sendfile writes at the destination's own offset but nothing else uses it as every other read and write is positional
+    off_t sin = in_off + done;
+    if (lseek(to->fd, out_off + done, SEEK_SET) < 0)
+        return done;
+    while (done < len)
+    {
+        ssize_t res = sendfile(to->fd, from->fd, &sin, len - done);
+        if (res <= 0)
+            break;
+        done += res;
+    }
+    return done;
+}
+
+mret_t merry_file_size(MerryFile *file, mqptr_t size)
+{
+    struct stat st;
+    if (fstat(file->fd, &st) != 0)
+        return RET_FAILURE;
+    *size = st.st_size;
+    return RET_SUCCESS;
+}
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+// there is no preadv or pwritev but everything on one handle is done by the same pool thread
+_MERRY_INTERNAL_ msize_t merry_file_rw(MerryFile *file, MerryIOVec *iov, msize_t count, mqword_t offset, mbool_t is_read)
+{
+    msize_t len = merry_file_iov_len(iov, count);
+    mbool_t claimed = offset == _MERRY_FILE_CUR_POS_;
+    if (claimed == mtrue)
+        offset = merry_file_claim(file, len);
+    msize_t done = 0;
+    if (_lseeki64(file->fd, offset, SEEK_SET) >= 0)
+    {
+        for (msize_t i = 0; i < count; i++)
+        {
+            int res = (is_read == mtrue) ? _read(file->fd, iov[i].iov_base, (unsigned)iov[i].iov_len) : _write(file->fd, iov[i].iov_base, (unsigned)iov[i].iov_len);
+            if (res <= 0)
+                break;
+            done += res;
+            if ((msize_t)res < iov[i].iov_len)
+                break;
+        }
+    }
+    if (claimed == mtrue)
+        merry_file_settle(file, offset, len, done, is_read);
+    return done;
+}
+
+mret_t merry_file_size(MerryFile *file, mqptr_t size)
+{
+    __int64 len = _filelengthi64(file->fd);
+    if (len < 0)
+        return RET_FAILURE;
+    *size = len;
+    return RET_SUCCESS;
+}
+#endif
+
+msize_t merry_file_read(MerryFile *file, MerryIOVec *iov, msize_t count, mqword_t offset)
+{
+    return merry_file_rw(file, iov, count, offset, mtrue);
+}
+
+msize_t merry_file_write(MerryFile *file, MerryIOVec *iov, msize_t count, mqword_t offset)
+{
+    return merry_file_rw(file, iov, count, offset, mfalse);
+}
+
+msize_t merry_file_copy(MerryFile *to, MerryFile *from, msize_t len)
+{
+    mqword_t in_off = merry_file_claim(from, len);
+    mqword_t out_off = merry_file_claim(to, len);
+    msize_t done = 0;
+#if defined(_MERRY_HOST_OS_LINUX_)
+    done = merry_file_copy_in_kernel(to, from, in_off, out_off, len);
+#endif
+    if (done < len)
+    {
+        // the host couldn't do it alone or the source ended; for the latter, a read tells us so
+        mbyte_t buf[_MERRY_FILE_COPY_BUF_LEN_];
+        MerryIOVec iov;
+        iov.iov_base = buf;
+        while (done < len)
+        {
+            iov.iov_len = (len - done < sizeof(buf)) ? len - done : sizeof(buf);
+            msize_t got = merry_file_read(from, &iov, 1, in_off + done);
+            if (got == 0)
+                break;
+            iov.iov_len = got;
+            msize_t put = merry_file_write(to, &iov, 1, out_off + done);
+            done += put;
+            if (put < got)
+                break;
+        }
+    }
+    merry_file_settle(from, in_off, len, done, mtrue);
+    merry_file_settle(to, out_off, len, done, mfalse);
+    return done;
+}
+
+mret_t merry_file_seek(MerryFile *file, msqword_t offset, mqword_t whence, mqptr_t new_pos)
+{
+    // the position is only ours and so only SEEK_END needs to ask the host
+    msqword_t base = 0;
+    mqword_t size;
+    switch (whence)
+    {
+    case _MERRY_FILE_SEEK_SET_:
+        break;
+    case _MERRY_FILE_SEEK_CUR_:
+        base = atomic_load(&file->pos);
+        break;
+    case _MERRY_FILE_SEEK_END_:
+        if (merry_file_size(file, &size) == RET_FAILURE)
+            return RET_FAILURE;
+        base = size;
+        break;
+    default:
+        return RET_FAILURE;
+    }
+    if (base + offset < 0)
+        return RET_FAILURE;
+    *new_pos = base + offset;
+    atomic_store(&file->pos, *new_pos);
+    atomic_store(&file->eof, mfalse);
+    return RET_SUCCESS;
+}
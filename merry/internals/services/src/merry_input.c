@@ -1,10 +1,331 @@
 #include "../merry_input.h"
 
+#if defined(_MERRY_HOST_OS_WINDOWS_)
+#define read _read
+#endif
+
+_MERRY_INTERNAL_ MerryInReader reader;
+
+// exactly representable powers of ten
+_MERRY_INTERNAL_ const double merry_in_pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+mret_t merry_in_init()
+{
+    reader.pos = 0;
+    reader.len = 0;
+    reader.eof = mfalse;
+    if ((reader.lock = merry_mutex_init()) == RET_NULL)
+        return RET_FAILURE;
+    return RET_SUCCESS;
+}
+
+void merry_in_destroy()
+{
+    merry_mutex_destroy(reader.lock);
+    reader.lock = NULL;
+}
+
+_MERRY_INTERNAL_ mbool_t merry_in_refill()
+{
+    if (reader.eof == mtrue)
+        return mfalse;
+    // stdio would have done this for us before blocking on the console and it may have a prompt in it
+    fflush(stdout);
+    long got = read(0, reader.buf, _MERRY_IN_BUF_LEN_);
+    if (got <= 0)
+    {
+        reader.eof = mtrue;
+        return mfalse;
+    }
+    reader.pos = 0;
+    reader.len = got;
+    return mtrue;
+}
+
+// the next byte without consuming it or -1 at the end
+_MERRY_INTERNAL_ int merry_in_peek()
+{
+    if (reader.pos == reader.len && merry_in_refill() == mfalse)
+        return -1;
+    return (unsigned char)reader.buf[reader.pos];
+}
+
+_MERRY_INTERNAL_ int merry_in_skip_space()
+{
+    int c;
+    while ((c = merry_in_peek()) == ' ' || (c >= '\t' && c <= '\r'))
+        reader.pos++;
+    return c;
+}
+
+msqword_t merry_in_char()
+{
+    merry_mutex_lock(reader.lock);
+    int c = merry_in_peek();
+    if (c != -1)
+        reader.pos++;
+    merry_mutex_unlock(reader.lock);
+    return c;
+}
+
+void merry_in_bytes(mbptr_t to, msize_t len)
+{
+    merry_mutex_lock(reader.lock);
+    while (len > 0)
+    {
+        if (reader.pos == reader.len)
+        {
+            if (reader.eof == mfalse && len >= _MERRY_IN_BUF_LEN_)
+            {
+                // no point going through the block for something this big
+                fflush(stdout);
+                long got = read(0, to, len);
+                if (got > 0)
+                {
+                    to += got;
+                    len -= got;
+                    continue;
+                }
+                reader.eof = mtrue;
+            }
+            if (merry_in_refill() == mfalse)
+            {
+                memset(to, 0xFF, len); // what getchar would have given
+                break;
+            }
+        }
+        msize_t avail = reader.len - reader.pos;
+        msize_t n = avail < len ? avail : len;
+        memcpy(to, reader.buf + reader.pos, n);
+        reader.pos += n;
+        to += n;
+        len -= n;
+    }
+    merry_mutex_unlock(reader.lock);
+}
+
+_MERRY_INTERNAL_ int merry_in_digit(int c, mqword_t base)
+{
+    int d = 99;
+    if (c >= '0' && c <= '9')
+        d = c - '0';
+    else if (c >= 'a' && c <= 'f')
+        d = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+        d = c - 'A' + 10;
+    return d < (int)base ? d : -1;
+}
+
+mret_t merry_in_integer(mqptr_t value, mbool_t any_base)
+{
+    merry_mutex_lock(reader.lock);
+    int c = merry_in_skip_space();
+    mbool_t negative = mfalse, any = mfalse;
+    mqword_t base = 10, result = 0;
+    if (c == '+' || c == '-')
+    {
+        negative = c == '-';
+        reader.pos++;
+        c = merry_in_peek();
+    }
+    if (any_base == mtrue && c == '0')
+    {
+        reader.pos++;
+        any = mtrue; // the 0 is a number by itself
+        c = merry_in_peek();
+        if (c == 'x' || c == 'X')
+        {
+            reader.pos++;
+            base = 16;
+        }
+        else
+            base = 8;
+    }
+    int d;
+    while ((d = merry_in_digit(merry_in_peek(), base)) != -1)
+    {
+        result = result * base + d;
+        any = mtrue;
+        reader.pos++;
+    }
+    merry_mutex_unlock(reader.lock);
+    if (any == mfalse)
+        return RET_FAILURE;
+    *value = negative == mtrue ? 0 - result : result;
+    return RET_SUCCESS;
+}
+
+_MERRY_INTERNAL_ mret_t merry_in_special(mbool_t negative, double *value)
+{
+    // inf, infinity or nan in any case
+    char word[16];
+    msize_t len = 0;
+    int c;
+    while (len < sizeof(word) - 1 && (((c = merry_in_peek()) >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')))
+    {
+        word[len++] = (char)(c | 0x20);
+        reader.pos++;
+    }
+    word[len] = 0;
+    if (strcmp(word, "inf") == 0 || strcmp(word, "infinity") == 0)
+        *value = negative == mtrue ? -HUGE_VAL : HUGE_VAL;
+    else if (strcmp(word, "nan") == 0)
+        *value = negative == mtrue ? -NAN : NAN;
+    else
+        return RET_FAILURE;
+    return RET_SUCCESS;
+}
+
+_MERRY_INTERNAL_ mret_t merry_in_real(double *value, float *value32)
+{
+    // reads into value32 instead if it isn't NULL; going through a double first would round twice
+    // the value is digits * 10^exp where digits are the significant digits as an integer
+    char digits[_MERRY_IN_DIGITS_MAX_ + 2];
+    msize_t count = 0;
+    long exp = 0;
+    mbool_t negative = mfalse, any = mfalse, sticky = mfalse, point = mfalse;
+    mret_t ret = RET_SUCCESS;
+    merry_mutex_lock(reader.lock);
+    int c = merry_in_skip_space();
+    if (c == '+' || c == '-')
+    {
+        negative = c == '-';
+        reader.pos++;
+        c = merry_in_peek();
+    }
+    if (c == 'i' || c == 'I' || c == 'n' || c == 'N')
+    {
+        double d;
+        ret = merry_in_special(negative, &d);
+        merry_mutex_unlock(reader.lock);
+        if (ret == RET_SUCCESS && value32 != NULL)
+            *value32 = (float)d; // infinity and nan stay what they are
+        else if (ret == RET_SUCCESS)
+            *value = d;
+        return ret;
+    }
+    while (mtrue)
+    {
+        c = merry_in_peek();
+        if (c == '.' && point == mfalse)
+        {
+            point = mtrue;
+            reader.pos++;
+            continue;
+        }
+        if (c < '0' || c > '9')
+            break;
+        reader.pos++;
+        any = mtrue;
+        if (count == 0 && c == '0')
+        {
+            // leading zeros only matter after the point
+            if (point == mtrue)
+                exp--;
+            continue;
+        }
+        if (count < _MERRY_IN_DIGITS_MAX_)
+        {
+            digits[count++] = (char)c;
+            if (point == mtrue)
+                exp--;
+        }
+        else
+        {
+            // too many digits to matter except for which way to round
+            if (c != '0')
+                sticky = mtrue;
+            if (point == mfalse)
+                exp++;
+        }
+    }
+    if (any == mfalse)
+    {
+        merry_mutex_unlock(reader.lock);
+        return RET_FAILURE;
+    }
+    if (c == 'e' || c == 'E')
+    {
+        reader.pos++;
+        mbool_t exp_neg = mfalse;
+        long e = 0;
+        c = merry_in_peek();
+        if (c == '+' || c == '-')
+        {
+            exp_neg = c == '-';
+            reader.pos++;
+        }
+        while ((c = merry_in_peek()) >= '0' && c <= '9')
+        {
+            if (e < 100000) // far past where everything is 0 or infinity
+                e = e * 10 + (c - '0');
+            reader.pos++;
+        }
+        exp += exp_neg == mtrue ? -e : e;
+    }
+    merry_mutex_unlock(reader.lock);
+    if (sticky == mtrue)
+    {
+        digits[count++] = '1';
+        exp--;
+    }
+    if (count == 0)
+    {
+        if (value32 != NULL)
+            *value32 = negative == mtrue ? -0.0f : 0.0f;
+        else
+            *value = negative == mtrue ? -0.0 : 0.0;
+        return RET_SUCCESS;
+    }
+    if (value32 != NULL && count <= 7 && exp >= -10 && exp <= 10)
+    {
+        // the same but with the digits and the powers that a float holds exactly
+        mdword_t m = 0;
+        for (msize_t i = 0; i < count; i++)
+            m = m * 10 + (digits[i] - '0');
+        float f = (float)m;
+        float p = (float)merry_in_pow10[exp < 0 ? -exp : exp];
+        f = exp < 0 ? f / p : f * p;
+        *value32 = negative == mtrue ? -f : f;
+        return RET_SUCCESS;
+    }
+    if (value32 == NULL && count <= 15 && exp >= -22 && exp <= 22)
+    {
+        // the digits and the power of ten are both exact and so one operation rounds correctly
+        mqword_t m = 0;
+        for (msize_t i = 0; i < count; i++)
+            m = m * 10 + (digits[i] - '0');
+        double d = (double)m;
+        d = exp < 0 ? d / merry_in_pow10[-exp] : d * merry_in_pow10[exp];
+        *value = negative == mtrue ? -d : d;
+        return RET_SUCCESS;
+    }
+    // the rare ones are left to strtod; there is no decimal point to trip over the locale
+    char num[_MERRY_IN_DIGITS_MAX_ + 32];
+    snprintf(num, sizeof(num), "%s%.*se%ld", negative == mtrue ? "-" : "", (int)count, digits, exp);
+    if (value32 != NULL)
+        *value32 = strtof(num, NULL);
+    else
+        *value = strtod(num, NULL);
+    return RET_SUCCESS;
+}
+
+mret_t merry_in_double(double *value)
+{
+    return merry_in_real(value, NULL);
+}
+
+mret_t merry_in_float(float *value)
+{
+    return merry_in_real(NULL, value);
+}
+
 mret_t merry_read_char(MerryDMemory *mem, maddress_t address)
 {
     mbptr_t _store_in;
-    if ((_store_in = merry_dmemory_get_byte_address(mem, address)) == RET_NULL)
+    if ((_store_in = merry_dmemory_get_byte_address_store(mem, address, 0)) == RET_NULL)
         return RET_FAILURE;
-    *_store_in = getchar();
+    *_store_in = (mbyte_t)merry_in_char();
     return RET_SUCCESS;
-}
\ No newline at end of file
+}
@@ -7,4 +7,158 @@ mret_t merry_write_char(MerryDMemory *mem, maddress_t address)
         return RET_FAILURE;
     putchar(*(int*)_to_write);
     return RET_SUCCESS;
-}
\ No newline at end of file
+}
+void merry_out_flush(MerryOutBuffer *out)
+{
+    if (out->len == 0)
+        return;
+    fwrite(out->buf, 1, out->len, stdout);
+    out->len = 0;
+}
+
+void merry_out_write(MerryOutBuffer *out, mbptr_t bytes, msize_t len)
+{
+    // there is no point in copying what is going to be written in one call anyway
+    merry_out_flush(out);
+    fwrite(bytes, 1, len, stdout);
+}
+
+void merry_out_format(MerryOutBuffer *out, mcstr_t format, ...)
+{
+    va_list args;
+    msize_t room = _MERRY_OUT_BUF_LEN_ - out->len;
+    va_start(args, format);
+    int len = vsnprintf(out->buf + out->len, room, format, args);
+    va_end(args);
+    if (len < 0)
+        return;
+    if ((msize_t)len >= room)
+    {
+        // it didn't fit and so make room and try again; nothing formatted by a core is ever longer than the buffer
+        merry_out_flush(out);
+        va_start(args, format);
+        len = vsnprintf(out->buf, _MERRY_OUT_BUF_LEN_, format, args);
+        va_end(args);
+        if (len < 0)
+            return;
+        if ((msize_t)len >= _MERRY_OUT_BUF_LEN_)
+            len = _MERRY_OUT_BUF_LEN_ - 1;
+    }
+    mbool_t line = memchr(out->buf + out->len, '\n', len) != NULL;
+    out->len += len;
+    if (line == mtrue || out->len == _MERRY_OUT_BUF_LEN_)
+        merry_out_flush(out);
+}
+
+// every number below 100 as two characters so that the digits can be produced two at a time
+_MERRY_INTERNAL_ const char merry_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+#define _MERRY_OUT_NUM_LEN_ 32 // longer than any number printed without snprintf
+
+_MERRY_INTERNAL_ char *merry_out_digits(char *end, mqword_t value)
+{
+    // the digits are written backwards ending right before end and the first one is returned
+    while (value >= 100)
+    {
+        msize_t i = (value % 100) * 2;
+        value /= 100;
+        *--end = merry_digit_pairs[i + 1];
+        *--end = merry_digit_pairs[i];
+    }
+    if (value >= 10)
+    {
+        *--end = merry_digit_pairs[value * 2 + 1];
+        *--end = merry_digit_pairs[value * 2];
+    }
+    else
+        *--end = '0' + (char)value;
+    return end;
+}
+
+_MERRY_INTERNAL_ void merry_out_append(MerryOutBuffer *out, char *bytes, msize_t len)
+{
+    // numbers never have a newline and so only a full buffer is flushed
+    if (_MERRY_OUT_BUF_LEN_ - out->len < len)
+        merry_out_flush(out);
+    memcpy(out->buf + out->len, bytes, len);
+    out->len += len;
+    if (out->len == _MERRY_OUT_BUF_LEN_)
+        merry_out_flush(out);
+}
+
+void merry_out_unsigned(MerryOutBuffer *out, mqword_t value)
+{
+    char num[_MERRY_OUT_NUM_LEN_];
+    char *end = num + _MERRY_OUT_NUM_LEN_;
+    char *start = merry_out_digits(end, value);
+    merry_out_append(out, start, end - start);
+}
+
+void merry_out_signed(MerryOutBuffer *out, msqword_t value)
+{
+    char num[_MERRY_OUT_NUM_LEN_];
+    char *end = num + _MERRY_OUT_NUM_LEN_;
+    // negating in unsigned works for the smallest value as well
+    char *start = merry_out_digits(end, value < 0 ? 0 - (mqword_t)value : (mqword_t)value);
+    if (value < 0)
+        *--start = '-';
+    merry_out_append(out, start, end - start);
+}
+
+void merry_out_double(MerryOutBuffer *out, double value)
+{
+#if defined(__SIZEOF_INT128__)
+    // "%f" is the value rounded to 6 decimal places with ties going to the even digit, which is exact for a double m*2^e
+    // As long as the value scaled by 10^6 fits in a qword it can be done with integers; everything else is rare enough for snprintf
+    mqword_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    mbool_t negative = (bits >> 63) != 0;
+    int exp = (int)((bits >> 52) & 0x7FF);
+    mqword_t mant = bits & 0xFFFFFFFFFFFFFULL;
+    if (exp != 0x7FF && (value < 0 ? -value : value) < 9.0e12)
+    {
+        mqword_t scaled; // the value * 10^6 rounded
+        if (exp == 0)
+            exp = 1; // subnormal
+        else
+            mant |= 1ULL << 52;
+        int shift = 1075 - exp; // value = mant / 2^shift
+        if (shift <= 0)
+            scaled = (mant << -shift) * 1000000; // a whole number which the bound keeps from overflowing
+        else if (shift >= 128)
+            scaled = 0; // far smaller than half of 10^-6
+        else
+        {
+            unsigned __int128 prod = (unsigned __int128)mant * 1000000;
+            unsigned __int128 rem = prod & ((((unsigned __int128)1) << shift) - 1);
+            unsigned __int128 half = ((unsigned __int128)1) << (shift - 1);
+            scaled = (mqword_t)(prod >> shift);
+            if (rem > half || (rem == half && (scaled & 1)))
+                scaled++;
+        }
+        char num[_MERRY_OUT_NUM_LEN_];
+        char *end = num + _MERRY_OUT_NUM_LEN_;
+        mqword_t frac = scaled % 1000000;
+        char *start = end - 6;
+        for (char *d = end; d > start; frac /= 10)
+            *--d = '0' + (char)(frac % 10);
+        *--start = '.';
+        start = merry_out_digits(start, scaled / 1000000);
+        if (negative == mtrue)
+            *--start = '-';
+        merry_out_append(out, start, end - start);
+        return;
+    }
+#endif
+    merry_out_format(out, "%f", value);
+}
@@ -0,0 +1,46 @@
+/*
+ * Byte order inversion for the Merry VM
+ * MIT License
+ *
+ * Copyright (c) 2024 MegrajChauhan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _MERRY_BSWAP_
+#define _MERRY_BSWAP_
+
+// Inverting the byte order of qwords
+// The reader has to do this for every qword of the input file if the host's byte ordering is different which gets slow for large input files
+// There are vectorized variants for the hosts that support them and the best one is picked at runtime
+
+#include "../../../utils/merry_types.h"
+#include "../../../utils/merry_config.h"
+
+_MERRY_DEFINE_FUNC_PTR_(void, mbswapfunc_t, mqptr_t, msize_t)
+
+// invert the byte order of count qwords starting at buf in place
+void merry_bswap64(mqptr_t buf, msize_t count);
+
+// the variant that doesn't use any vector instructions(always available)
+void merry_bswap64_generic(mqptr_t buf, msize_t count);
+
+// the name of the variant that merry_bswap64 uses on this host
+mcstr_t merry_bswap64_variant();
+
+#endif
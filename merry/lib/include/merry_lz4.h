@@ -0,0 +1,50 @@
+/*
+ * LZ4 block compression for the Merry VM
+ * MIT License
+ *
+ * Copyright (c) 2024 MegrajChauhan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _MERRY_LZ4_
+#define _MERRY_LZ4_
+
+// A small implementation of the LZ4 block format
+// Compressed input files are made of pages compressed independently with this and so the reader can decompress them in parallel
+// It is not the fastest compressor out there but the decompressor is what matters and it is as simple as it can be
+
+#include "../../../utils/merry_types.h"
+#include "../../../utils/merry_config.h"
+#include <string.h>
+
+#define _MERRY_LZ4_MIN_MATCH_ 4
+#define _MERRY_LZ4_HASH_BITS_ 12
+#define _MERRY_LZ4_MAX_OFFSET_ 65535
+#define _MERRY_LZ4_LAST_LITERALS_ 5 // the last 5 bytes are always literals
+#define _MERRY_LZ4_MFLIMIT_ 12      // a match cannot start within the last 12 bytes
+
+// compress len bytes from src into dst which has cap bytes
+// returns the compressed length or 0 if the result doesn't fit in cap bytes
+msize_t merry_lz4_compress(mbptr_t src, msize_t len, mbptr_t dst, msize_t cap);
+
+// decompress len bytes from src into dst which has cap bytes
+// returns RET_FAILURE if the input is malformed or doesn't decompress to exactly cap bytes
+mret_t merry_lz4_decompress(mbptr_t src, msize_t len, mbptr_t dst, msize_t cap);
+
+#endif
@@ -0,0 +1,89 @@
+#include "../include/merry_bswap.h"
+#include <stdatomic.h>
+
+#if defined(_MERRY_HOST_CPU_x86_64_ARCH_)
+#include <immintrin.h>
+#endif
+
+void merry_bswap64_generic(mqptr_t buf, msize_t count)
+{
+    // the compiler turns this into bswap or rev
+    for (msize_t i = 0; i < count; i++)
+        buf[i] = __builtin_bswap64(buf[i]);
+}
+
+#if defined(_MERRY_HOST_CPU_x86_64_ARCH_)
+// the shuffle mask that reverses the 8 bytes of every qword in a 128-bit lane
+#define _MERRY_BSWAP_MASK_ 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7
+
+__attribute__((target("ssse3"))) _MERRY_INTERNAL_ void merry_bswap64_ssse3(mqptr_t buf, msize_t count)
+{
+    const __m128i mask = _mm_set_epi8(_MERRY_BSWAP_MASK_);
+    msize_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i v = _mm_loadu_si128((__m128i *)(buf + i));
+        _mm_storeu_si128((__m128i *)(buf + i), _mm_shuffle_epi8(v, mask));
+    }
+    merry_bswap64_generic(buf + i, count - i);
+}
+
+__attribute__((target("avx2"))) _MERRY_INTERNAL_ void merry_bswap64_avx2(mqptr_t buf, msize_t count)
+{
+    // pshufb works on each 128-bit lane separately and so the same mask is repeated for both lanes
+    const __m256i mask = _mm256_set_epi8(_MERRY_BSWAP_MASK_, _MERRY_BSWAP_MASK_);
+    msize_t i = 0;
+    // two vectors per iteration keeps both load ports busy
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i v1 = _mm256_loadu_si256((__m256i *)(buf + i));
+        __m256i v2 = _mm256_loadu_si256((__m256i *)(buf + i + 4));
+        _mm256_storeu_si256((__m256i *)(buf + i), _mm256_shuffle_epi8(v1, mask));
+        _mm256_storeu_si256((__m256i *)(buf + i + 4), _mm256_shuffle_epi8(v2, mask));
+    }
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256i v = _mm256_loadu_si256((__m256i *)(buf + i));
+        _mm256_storeu_si256((__m256i *)(buf + i), _mm256_shuffle_epi8(v, mask));
+    }
+    merry_bswap64_generic(buf + i, count - i);
+}
+#endif
+
+_MERRY_INTERNAL_ mcstr_t merry_bswap64_select(mbswapfunc_t *func)
+{
+#if defined(_MERRY_HOST_CPU_x86_64_ARCH_)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        *func = &merry_bswap64_avx2;
+        return "avx2";
+    }
+    if (__builtin_cpu_supports("ssse3"))
+    {
+        *func = &merry_bswap64_ssse3;
+        return "ssse3";
+    }
+#endif
+    *func = &merry_bswap64_generic;
+    return "generic";
+}
+
+void merry_bswap64(mqptr_t buf, msize_t count)
+{
+    // the reader calls this from multiple threads; they may all select the variant at once but every one of them stores the same one
+    _MERRY_LOCAL_ _Atomic(mbswapfunc_t) selected = NULL;
+    mbswapfunc_t func = atomic_load_explicit(&selected, memory_order_relaxed);
+    if (surelyF(func == NULL))
+    {
+        merry_bswap64_select(&func);
+        atomic_store_explicit(&selected, func, memory_order_relaxed);
+    }
+    func(buf, count);
+}
+
+mcstr_t merry_bswap64_variant()
+{
+    mbswapfunc_t func;
+    return merry_bswap64_select(&func);
+}
@@ -0,0 +1,145 @@
+#include "../include/merry_lz4.h"
+
+_MERRY_INTERNAL_ inline mdword_t merry_lz4_read32(mbptr_t p)
+{
+    mdword_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+_MERRY_INTERNAL_ inline mdword_t merry_lz4_hash(mdword_t v)
+{
+    return (v * 2654435761U) >> (32 - _MERRY_LZ4_HASH_BITS_);
+}
+
+_MERRY_INTERNAL_ mbptr_t merry_lz4_write_len(mbptr_t op, mbptr_t end, msize_t len)
+{
+    // the lengths that don't fit in the token's nibble are continued with bytes of 255 followed by the remainder
+    while (len >= 255)
+    {
+        if (op >= end)
+            return RET_NULL;
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op >= end)
+        return RET_NULL;
+    *op++ = (mbyte_t)len;
+    return op;
+}
+
+_MERRY_INTERNAL_ mbptr_t merry_lz4_write_sequence(mbptr_t op, mbptr_t end, mbptr_t literals, msize_t lit_len, msize_t offset, msize_t match_len)
+{
+    // a sequence is a token, the literals and then the match
+    // the last sequence has no match and match_len is 0 for it
+    if (op >= end)
+        return RET_NULL;
+    mbptr_t token = op++;
+    msize_t mcode = match_len == 0 ? 0 : match_len - _MERRY_LZ4_MIN_MATCH_;
+    *token = (mbyte_t)(((lit_len >= 15 ? 15 : lit_len) << 4) | (mcode >= 15 ? 15 : mcode));
+    if (lit_len >= 15 && (op = merry_lz4_write_len(op, end, lit_len - 15)) == RET_NULL)
+        return RET_NULL;
+    if ((msize_t)(end - op) < lit_len)
+        return RET_NULL;
+    memcpy(op, literals, lit_len);
+    op += lit_len;
+    if (match_len == 0)
+        return op;
+    if (end - op < 2)
+        return RET_NULL;
+    *op++ = (mbyte_t)(offset & 0xFF);
+    *op++ = (mbyte_t)(offset >> 8);
+    if (mcode >= 15 && (op = merry_lz4_write_len(op, end, mcode - 15)) == RET_NULL)
+        return RET_NULL;
+    return op;
+}
+
+msize_t merry_lz4_compress(mbptr_t src, msize_t len, mbptr_t dst, msize_t cap)
+{
+    // the table holds the position + 1 of the last place every hash was seen and so 0 means never seen
+    mdword_t table[1 << _MERRY_LZ4_HASH_BITS_] = {0};
+    mbptr_t op = dst, end = dst + cap;
+    msize_t anchor = 0, ip = 0;
+    msize_t limit = len > _MERRY_LZ4_MFLIMIT_ ? len - _MERRY_LZ4_MFLIMIT_ : 0;
+    msize_t match_limit = len > _MERRY_LZ4_LAST_LITERALS_ ? len - _MERRY_LZ4_LAST_LITERALS_ : 0;
+    while (ip < limit)
+    {
+        mdword_t seq = merry_lz4_read32(src + ip);
+        mdword_t h = merry_lz4_hash(seq);
+        msize_t ref = table[h];
+        table[h] = (mdword_t)(ip + 1);
+        if (ref == 0 || ip - (ref - 1) > _MERRY_LZ4_MAX_OFFSET_ || merry_lz4_read32(src + ref - 1) != seq)
+        {
+            ip++;
+            continue;
+        }
+        ref--;
+        msize_t match_len = _MERRY_LZ4_MIN_MATCH_;
+        while (ip + match_len < match_limit && src[ref + match_len] == src[ip + match_len])
+            match_len++;
+        if ((op = merry_lz4_write_sequence(op, end, src + anchor, ip - anchor, ip - ref, match_len)) == RET_NULL)
+            return 0;
+        ip += match_len;
+        anchor = ip;
+    }
+    if ((op = merry_lz4_write_sequence(op, end, src + anchor, len - anchor, 0, 0)) == RET_NULL)
+        return 0;
+    return op - dst;
+}
+
+_MERRY_INTERNAL_ mret_t merry_lz4_read_len(mbptr_t *ip, mbptr_t end, msize_t *len)
+{
+    mbyte_t b;
+    do
+    {
+        if (*ip >= end)
+            return RET_FAILURE;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return RET_SUCCESS;
+}
+
+mret_t merry_lz4_decompress(mbptr_t src, msize_t len, mbptr_t dst, msize_t cap)
+{
+    // every length and offset is checked against the buffers since the input comes straight from the file
+    mbptr_t ip = src, iend = src + len;
+    mbptr_t op = dst, oend = dst + cap;
+    while (ip < iend)
+    {
+        mbyte_t token = *ip++;
+        msize_t lit_len = token >> 4;
+        if (lit_len == 15 && merry_lz4_read_len(&ip, iend, &lit_len) == RET_FAILURE)
+            return RET_FAILURE;
+        if ((msize_t)(iend - ip) < lit_len || (msize_t)(oend - op) < lit_len)
+            return RET_FAILURE;
+        memcpy(op, ip, lit_len);
+        op += lit_len;
+        ip += lit_len;
+        if (ip == iend)
+            break; // the last sequence has only literals
+        if (iend - ip < 2)
+            return RET_FAILURE;
+        msize_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (msize_t)(op - dst))
+            return RET_FAILURE;
+        msize_t match_len = token & 15;
+        if (match_len == 15 && merry_lz4_read_len(&ip, iend, &match_len) == RET_FAILURE)
+            return RET_FAILURE;
+        match_len += _MERRY_LZ4_MIN_MATCH_;
+        if ((msize_t)(oend - op) < match_len)
+            return RET_FAILURE;
+        mbptr_t ref = op - offset;
+        if (offset >= match_len)
+            memcpy(op, ref, match_len);
+        else
+        {
+            // the match overlaps what it is producing and so it has to be copied byte by byte
+            for (msize_t i = 0; i < match_len; i++)
+                op[i] = ref[i];
+        }
+        op += match_len;
+    }
+    return op == oend ? RET_SUCCESS : RET_FAILURE;
+}
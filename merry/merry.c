@@ -8,7 +8,7 @@ MerryCLP *merry_parse_options(int argc, char **argv)
         fprintf(stderr, "Error parsing command line options.\n");
         return RET_NULL;
     }
-    MerryCLP *clp = (MerryCLP *)malloc(sizeof(MerryCLP));
+    MerryCLP *clp = (MerryCLP *)calloc(1, sizeof(MerryCLP)); // nothing is provided to begin with
     if (clp == NULL)
     {
         // This is funny and unintended.
@@ -78,6 +78,56 @@ MerryCLP *merry_parse_options(int argc, char **argv)
             case 'l':
                 clp->options[_OPT_ENABLE_LOGGER].provided = mtrue;
                 break;
+            case 'p':
+                // the list of CPUs to pin the cores to
+                if (argc < (i + 2))
+                {
+                    fprintf(stderr, "Expected a list of CPUs after '-p' option, got EOF instead.\n");
+                    free(clp);
+                    return RET_NULL;
+                }
+                clp->options[_OPT_PIN_CPUS].provided = mtrue;
+                clp->options[_OPT_PIN_CPUS]._given_value_str_ = &argv[i + 1];
+                i++;
+                break;
+            case 'n':
+                clp->options[_OPT_NUMA].provided = mtrue;
+                break;
+            case 'm':
+                if (argc < (i + 2) || (strcmp(argv[i + 1], "interleave") != 0 && strcmp(argv[i + 1], "local") != 0))
+                {
+                    fprintf(stderr, "Expected 'interleave' or 'local' after '-m' option.\n");
+                    free(clp);
+                    return RET_NULL;
+                }
+                clp->options[_OPT_DATA_POLICY].provided = mtrue;
+                clp->options[_OPT_DATA_POLICY]._given_value_str_ = &argv[i + 1];
+                i++;
+                break;
+            case 'w':
+                // the number of workers for the scheduler
+                if (argc < (i + 2))
+                {
+                    fprintf(stderr, "Expected the number of workers after '-w' option, got EOF instead.\n");
+                    free(clp);
+                    return RET_NULL;
+                }
+                clp->options[_OPT_WORKERS].provided = mtrue;
+                clp->options[_OPT_WORKERS]._given_value_str_ = &argv[i + 1];
+                i++;
+                break;
+            case 'c':
+                // the most cores the program may have at once
+                if (argc < (i + 2))
+                {
+                    fprintf(stderr, "Expected the number of cores after '-c' option, got EOF instead.\n");
+                    free(clp);
+                    return RET_NULL;
+                }
+                clp->options[_OPT_MAX_CORES].provided = mtrue;
+                clp->options[_OPT_MAX_CORES]._given_value_str_ = &argv[i + 1];
+                i++;
+                break;
             default:
                 fprintf(stderr, "Unknown option '%s'\n", argv[i]);
                 free(clp);
@@ -104,7 +154,14 @@ void merry_print_help()
             "-f                     --> Provide the path to the input file\n"
             "-l                     --> Enable logging of the VM[Disabled for now. Doesn't work]"
             "                           Enabling logging doesn't ensure that a log file will be generated."
-            "                           The performance will be affected.");
+            "                           The performance will be affected.\n"
+            "-p <cpus>              --> Pin the cores to the CPUs in the list(for eg: 0-3,8) in turn: core 0 to the first CPU, core 1 to the second and so on\n"
+            "-n                     --> Keep every core and its stack on one NUMA node(its CPU's node with -p or else the nodes in turn)\n"
+            "-m <interleave|local>  --> Spread the data memory over every NUMA node or leave it on the node that first touches it(the default)\n"
+            "                           The topology and the placement are printed at startup if any of -p, -n or -m is given\n"
+            "-w <workers>           --> Run the cores on this many threads instead of a thread for every core\n"
+            "                           A core waiting for a request then costs no thread and -p and -n place the threads instead of the cores\n"
+            "-c <cores>             --> The most cores the program may have at once(256 by default)\n");
 }
 
 void merry_destroy_parser(MerryCLP *clp)
@@ -0,0 +1,221 @@
+#include "internals/merry_call_pool.h"
+
+_MERRY_INTERNAL_ mqword_t merry_call_pool_now()
+{
+    // milliseconds from some fixed point in the past
+#if defined(_MERRY_HOST_OS_LINUX_)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (mqword_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+    return GetTickCount64();
+#endif
+}
+
+_MERRY_INTERNAL_ void merry_call_worker_free(MerryCallWorker *worker)
+{
+    merry_mutex_destroy(worker->lock);
+    merry_cond_destroy(worker->cond);
+    merry_thread_destroy(worker->thread);
+    free(worker);
+}
+
+_MERRY_INTERNAL_ _THRET_T_ merry_call_worker_run(mptr_t arg)
+{
+    MerryCallWorker *worker = (MerryCallWorker *)arg;
+    while (mtrue)
+    {
+        merry_mutex_lock(worker->lock);
+        while (atomic_load(&worker->state) != _MERRY_CALL_BUSY_ && worker->stop == mfalse)
+            merry_cond_wait(worker->cond, worker->lock);
+        merry_mutex_unlock(worker->lock);
+        if (atomic_load(&worker->state) != _MERRY_CALL_BUSY_)
+            break; // stopped
+        worker->exec(worker->function, &worker->sig, worker->args, worker->regs);
+        mbyte_t expected = _MERRY_CALL_BUSY_;
+        if (atomic_compare_exchange_strong(&worker->state, &expected, _MERRY_CALL_FINISHING_) == mfalse)
+        {
+            // the watchdog gave up on us and so nobody knows about us anymore
+            worker->release(worker->args, mfalse);
+            break;
+        }
+        // the pool is destroyed only once we are done with this
+        worker->release(worker->args, mtrue);
+        worker->request.regs[Ma] = worker->regs[Ma];
+        worker->request.regs[Mb] = _MERRY_CALL_OK_;
+        worker->done(&worker->request);
+        atomic_store(&worker->state, _MERRY_CALL_IDLE_);
+    }
+    // the worker is detached and so it cleans up after itself
+    merry_call_worker_free(worker);
+#if defined(_MERRY_HOST_OS_LINUX_)
+    return RET_NULL;
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+    return 0;
+#endif
+}
+
+_MERRY_INTERNAL_ MerryCallWorker *merry_call_worker_init(MerryCallPool *pool)
+{
+    MerryCallWorker *worker = (MerryCallWorker *)calloc(1, sizeof(MerryCallWorker));
+    if (worker == NULL)
+        return RET_NULL;
+    atomic_init(&worker->state, _MERRY_CALL_IDLE_);
+    worker->stop = mfalse;
+    worker->exec = pool->exec;
+    worker->release = pool->release;
+    worker->done = pool->done;
+    if ((worker->lock = merry_mutex_init()) == RET_NULL || (worker->cond = merry_cond_init()) == RET_NULL || (worker->thread = merry_thread_init()) == RET_NULL)
+        goto failure;
+    // nothing ever waits for a worker as it may be stuck in a call forever
+    if (merry_create_detached_thread(worker->thread, &merry_call_worker_run, worker) == RET_FAILURE)
+        goto failure;
+    return worker;
+failure:
+    merry_call_worker_free(worker);
+    return RET_NULL;
+}
+
+_MERRY_INTERNAL_ void merry_call_pool_poison(MerryCallPool *pool, msize_t index)
+{
+    // the worker frees itself once it sees that it was given up on and so the request must be copied first
+    MerryCallWorker *worker = pool->workers[index];
+    MerryOSRequest request = worker->request;
+    mbyte_t expected = _MERRY_CALL_BUSY_;
+    if (atomic_compare_exchange_strong(&worker->state, &expected, _MERRY_CALL_POISONED_) == mfalse)
+        return; // it returned just in time
+    request.regs[Ma] = 0;
+    request.regs[Mb] = _MERRY_CALL_TIMED_OUT_;
+    pool->done(&request);
+    pool->poisoned++;
+    // every poisoned worker is a thread that may never end and so only so many are replaced
+    pool->workers[index] = (pool->poisoned <= _MERRY_CALL_MAX_POISONED_) ? merry_call_worker_init(pool) : RET_NULL;
+}
+
+_MERRY_INTERNAL_ _THRET_T_ merry_call_pool_watch(mptr_t arg)
+{
+    MerryCallPool *pool = (MerryCallPool *)arg;
+    merry_mutex_lock(pool->lock);
+    while (pool->stop == mfalse)
+    {
+        // give up on whatever is late and sleep until the next deadline
+        mqword_t now = merry_call_pool_now(), next = 0;
+        for (msize_t i = 0; i < _MERRY_CALL_WORKERS_; i++)
+        {
+            MerryCallWorker *worker = pool->workers[i];
+            if (worker == RET_NULL || atomic_load(&worker->state) != _MERRY_CALL_BUSY_)
+                continue;
+            if (worker->deadline <= now)
+                merry_call_pool_poison(pool, i);
+            else if (next == 0 || worker->deadline < next)
+                next = worker->deadline;
+        }
+        if (next == 0)
+            merry_cond_wait(pool->cond, pool->lock);
+        else
+            merry_cond_timedwait(pool->cond, pool->lock, next - now);
+    }
+    merry_mutex_unlock(pool->lock);
+#if defined(_MERRY_HOST_OS_LINUX_)
+    return RET_NULL;
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+    return 0;
+#endif
+}
+
+MerryCallPool *merry_call_pool_init(merry_call_exec_t exec, merry_call_release_t release, merry_call_done_t done)
+{
+    MerryCallPool *pool = (MerryCallPool *)calloc(1, sizeof(MerryCallPool));
+    if (pool == NULL)
+        return RET_NULL;
+    pool->exec = exec;
+    pool->release = release;
+    pool->done = done;
+    pool->stop = mfalse;
+    if ((pool->lock = merry_mutex_init()) == RET_NULL || (pool->cond = merry_cond_init()) == RET_NULL)
+        goto failure;
+    for (msize_t i = 0; i < _MERRY_CALL_WORKERS_; i++)
+    {
+        if ((pool->workers[i] = merry_call_worker_init(pool)) == RET_NULL)
+            goto failure;
+    }
+    MerryThread *watchdog = merry_thread_init();
+    if (watchdog == RET_NULL)
+        goto failure;
+    if (merry_create_thread(watchdog, &merry_call_pool_watch, pool) == RET_FAILURE)
+    {
+        merry_thread_destroy(watchdog);
+        goto failure;
+    }
+    pool->watchdog = watchdog;
+    return pool;
+failure:
+    merry_call_pool_destroy(pool);
+    return RET_NULL;
+}
+
+mret_t merry_call_pool_call(MerryCallPool *pool, MerryOSRequest *request, dynfunc_t function, MerryDynSig *sig, mptr_t args, msize_t timeout)
+{
+    merry_mutex_lock(pool->lock);
+    for (msize_t i = 0; i < _MERRY_CALL_WORKERS_; i++)
+    {
+        MerryCallWorker *worker = pool->workers[i];
+        if (worker == RET_NULL || atomic_load(&worker->state) != _MERRY_CALL_IDLE_)
+            continue;
+        worker->request = *request;
+        memcpy(worker->regs, request->regs, sizeof(worker->regs));
+        worker->function = function;
+        worker->sig = *sig;
+        worker->args = args;
+        worker->deadline = merry_call_pool_now() + timeout;
+        merry_mutex_lock(worker->lock);
+        atomic_store(&worker->state, _MERRY_CALL_BUSY_);
+        merry_cond_signal(worker->cond);
+        merry_mutex_unlock(worker->lock);
+        // the watchdog has a new deadline to look out for
+        merry_cond_signal(pool->cond);
+        merry_mutex_unlock(pool->lock);
+        return RET_SUCCESS;
+    }
+    merry_mutex_unlock(pool->lock);
+    return RET_FAILURE;
+}
+
+void merry_call_pool_destroy(MerryCallPool *pool)
+{
+    if (pool == NULL)
+        return;
+    if (pool->watchdog != NULL)
+    {
+        merry_mutex_lock(pool->lock);
+        pool->stop = mtrue;
+        merry_cond_signal(pool->cond);
+        merry_mutex_unlock(pool->lock);
+        merry_thread_join(pool->watchdog, NULL);
+        merry_thread_destroy(pool->watchdog);
+    }
+    for (msize_t i = 0; i < _MERRY_CALL_WORKERS_; i++)
+    {
+        MerryCallWorker *worker = pool->workers[i];
+        if (worker == RET_NULL)
+            continue;
+        while (mtrue)
+        {
+            // the calls still running are given up on while the ones handing over their results are waited for
+            mbyte_t expected = _MERRY_CALL_BUSY_;
+            if (atomic_compare_exchange_strong(&worker->state, &expected, _MERRY_CALL_POISONED_) == mtrue)
+                break;
+            if (expected == _MERRY_CALL_IDLE_)
+            {
+                merry_mutex_lock(worker->lock);
+                worker->stop = mtrue;
+                merry_cond_signal(worker->cond);
+                merry_mutex_unlock(worker->lock);
+                break;
+            }
+        }
+    }
+    merry_mutex_destroy(pool->lock);
+    merry_cond_destroy(pool->cond);
+    free(pool);
+}
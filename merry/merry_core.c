@@ -29,6 +29,28 @@ MerryCore *merry_core_init(MerryMemory *inst_mem, MerryDMemory *data_mem, msize_
         free(new_core);
         return RET_NULL;
     }
+    new_core->completion.lock = new_core->lock;
+    new_core->completion.cond = new_core->cond;
+    new_core->completion.wake = RET_NULL;
+    new_core->completion.waiter = RET_NULL;
+    atomic_init(&new_core->completion.done, mfalse);
+    for (msize_t i = 0; i < _MERRY_ASYNC_SLOTS_; i++)
+    {
+        new_core->async[i].completion.lock = new_core->lock;
+        new_core->async[i].completion.cond = new_core->cond;
+        new_core->async[i].completion.wake = RET_NULL;
+        new_core->async[i].completion.waiter = RET_NULL;
+        atomic_init(&new_core->async[i].completion.done, mfalse);
+        new_core->async[i].in_use = mfalse;
+    }
+    new_core->sched = RET_NULL; // the core has its own thread unless the scheduler takes it
+    new_core->blocked_on = RET_NULL;
+    atomic_init(&new_core->run_state, _MERRY_CORE_READY_);
+    new_core->worker = 0;
+    new_core->next_free = RET_NULL;
+    new_core->retired = mfalse;
+    atomic_init(&new_core->host, _MERRY_CORE_IN_VM_);
+    new_core->out.len = 0;
     new_core->registers = (mqptr_t)malloc(sizeof(mqword_t) * REGR_COUNT);
     if (new_core->registers == RET_NULL)
         goto failure;
@@ -84,6 +106,23 @@ void merry_core_destroy(MerryCore *core)
     free(core);
 }
 
+void merry_core_reset(MerryCore *core, maddress_t start_addr)
+{
+    merry_core_zero_out_reg(core);
+    core->pc = start_addr;
+    core->sp = 0;
+    core->bp = 0;
+    memset(&core->flag, 0, sizeof(core->flag));
+    core->greater = mfalse;
+    core->ras->sp = 0;
+    core->out.len = 0;
+    core->blocked_on = RET_NULL;
+    // the tickets that the last program never collected are gone
+    for (msize_t i = 0; i < _MERRY_ASYNC_SLOTS_; i++)
+        core->async[i].in_use = mfalse;
+    core->stop_running = mfalse;
+}
+
 _MERRY_INTERNAL_ mqword_t merry_core_get_immediate(MerryCore *core)
 {
     mqword_t res = 0;
@@ -98,9 +137,184 @@ _MERRY_INTERNAL_ mqword_t merry_core_get_immediate(MerryCore *core)
     return res;
 }
 
-_THRET_T_ merry_runCore(mptr_t core)
+_MERRY_INTERNAL_ mret_t merry_core_async_submit(MerryCore *core, msize_t req_id)
+{
+    // The arguments are taken from the registers right now and so the program is free to change them after this
+    // The address of the descriptor is in Md and the ticket is returned in Md
+    if (!_MERRY_REQUEST_ASYNC_OK_(req_id))
+    {
+        merry_requestHdlr_panic(MERRY_INVALID_ASYNC_REQUEST);
+        return RET_FAILURE;
+    }
+    // the status and the results are stored into the descriptor and so it can't be in a read-only mapping
+    mqptr_t desc = merry_dmemory_get_qword_address_store(core->data_mem, core->registers[Md], _MERRY_ASYNC_DESC_LEN_);
+    if (desc == RET_NULL)
+    {
+        merry_requestHdlr_panic(core->data_mem->error);
+        return RET_FAILURE;
+    }
+    for (msize_t i = 0; i < _MERRY_ASYNC_SLOTS_; i++)
+    {
+        MerryAsyncSlot *slot = &core->async[i];
+        if (slot->in_use == mtrue)
+            continue;
+        slot->in_use = mtrue;
+        memcpy(slot->regs, core->registers, sizeof(slot->regs));
+        desc[_MERRY_ASYNC_DESC_STATUS_] = 0; // pending
+        if (merry_requestHdlr_push_async(req_id, core->core_id, &slot->completion, slot->regs, desc) == RET_FAILURE)
+            return RET_FAILURE;
+        core->registers[Md] = i;
+        return RET_SUCCESS;
+    }
+    merry_requestHdlr_panic(MERRY_ASYNC_SLOTS_FULL);
+    return RET_FAILURE;
+}
+
+_MERRY_INTERNAL_ mret_t merry_core_async_collect(MerryCore *core, msize_t dest, msize_t reg, mbool_t wait)
+{
+    // reg has the ticket and it is left untouched so that the program may poll it again
+    // dest is set to 1 if the request is done and the ticket collected or 0 if it isn't done yet
+    mqword_t ticket = core->registers[reg];
+    if (ticket >= _MERRY_ASYNC_SLOTS_ || core->async[ticket].in_use == mfalse)
+    {
+        merry_requestHdlr_panic(MERRY_INVALID_TICKET);
+        return RET_FAILURE;
+    }
+    MerryAsyncSlot *slot = &core->async[ticket];
+    if (wait == mtrue && core->sched != RET_NULL && atomic_load_explicit(&slot->completion.done, memory_order_acquire) == mfalse)
+    {
+        // park until the request is done and then run this AWAIT again
+        core->blocked_on = &slot->completion;
+        core->pc--;
+        return RET_SUCCESS;
+    }
+    if (wait == mtrue)
+        merry_requestHdlr_await(&slot->completion);
+    else if (atomic_load_explicit(&slot->completion.done, memory_order_acquire) == mfalse)
+    {
+        core->registers[dest] = 0;
+        return RET_SUCCESS;
+    }
+    slot->in_use = mfalse;
+    core->registers[dest] = 1;
+    return RET_SUCCESS;
+}
+
+_MERRY_INTERNAL_ mret_t merry_core_request(MerryCore *core, msize_t req_id)
+{
+    // A core with its own thread simply waits for the request right here
+    // A core run by the scheduler mustn't hold up the worker and so it is parked once this instruction is done and run again once the request is
+    if (core->sched == RET_NULL)
+        return merry_requestHdlr_push_request(req_id, core->core_id, &core->completion, core->registers);
+    core->blocked_on = &core->completion;
+    return merry_requestHdlr_push_async(req_id, core->core_id, &core->completion, core->registers, RET_NULL);
+}
+
+mbool_t merry_core_close(MerryCore *core)
+{
+    core->stop_running = mtrue;
+    while (mtrue)
+    {
+        mbyte_t expected = _MERRY_CORE_IN_VM_;
+        if (atomic_compare_exchange_strong(&core->host, &expected, _MERRY_CORE_CLOSED_) == mtrue || expected == _MERRY_CORE_CLOSED_)
+            return mtrue;
+        if (expected == _MERRY_CORE_ABANDONED_)
+            return mfalse;
+        // it may come back right now in which case we try again
+        if (atomic_compare_exchange_strong(&core->host, &expected, _MERRY_CORE_ABANDONED_) == mtrue)
+            return mfalse;
+    }
+}
+
+_MERRY_INTERNAL_ mret_t merry_core_enter_host(MerryCore *core)
+{
+    // the core may block in there forever and so the VM mustn't wait for it once it is being destroyed
+    mbyte_t expected = _MERRY_CORE_IN_VM_;
+    if (surelyT(atomic_compare_exchange_strong(&core->host, &expected, _MERRY_CORE_IN_HOST_) == mtrue))
+        return RET_SUCCESS;
+    core->stop_running = mtrue;
+    return RET_FAILURE;
+}
+
+_MERRY_INTERNAL_ void merry_core_leave_host(MerryCore *core)
+{
+    mbyte_t expected = _MERRY_CORE_IN_HOST_;
+    if (surelyT(atomic_compare_exchange_strong(&core->host, &expected, _MERRY_CORE_IN_VM_) == mtrue))
+        return;
+    // nobody waits for us anymore and the Manager may be gone along with everything else
+    merry_thread_exit();
+}
+
+_MERRY_INTERNAL_ void merry_core_read_integer(MerryCore *core, msize_t reg, msize_t len, mbool_t any_base)
+{
+    // only the lower len bytes of the register are replaced and nothing is if there was no number
+    mqword_t value;
+    merry_out_flush(&core->out);
+    if (merry_core_enter_host(core) == RET_FAILURE)
+        return;
+    mret_t ret = merry_in_integer(&value, any_base);
+    merry_core_leave_host(core);
+    if (ret == RET_SUCCESS)
+        memcpy(&core->registers[reg], &value, len);
+}
+
+_MERRY_INTERNAL_ void merry_core_read_float(MerryCore *core, msize_t reg, mbool_t is_32)
+{
+    merry_out_flush(&core->out);
+    if (merry_core_enter_host(core) == RET_FAILURE)
+        return;
+    if (is_32 == mtrue)
+    {
+        float f;
+        mret_t ret = merry_in_float(&f);
+        merry_core_leave_host(core);
+        if (ret == RET_SUCCESS)
+            memcpy(&core->registers[reg], &f, sizeof(f));
+        return;
+    }
+    double value;
+    mret_t ret = merry_in_double(&value);
+    merry_core_leave_host(core);
+    if (ret == RET_SUCCESS)
+        memcpy(&core->registers[reg], &value, sizeof(value));
+}
+
+_MERRY_INTERNAL_ mret_t merry_core_ncall(MerryCore *core)
+{
+    // A thread safe function is called right here on the core's own thread which keeps the Manager free and saves waking it up and waiting for it
+    // Everything else goes through the Manager which calls one function at a time
+    msize_t slot = core->registers[Mb];
+    dynfunc_t function = merry_loader_enter(slot);
+    if (function == RET_NULL)
+        return merry_core_request(core, _REQ_NCALL);
+    if (merry_core_enter_host(core) == RET_FAILURE)
+    {
+        merry_loader_leave(slot);
+        return RET_FAILURE;
+    }
+    mret_t ret = merry_os_call_slot(core->data_mem, function, slot, core->registers);
+    merry_loader_leave(slot);
+    merry_core_leave_host(core);
+    return ret;
+}
+
+_MERRY_INTERNAL_ mret_t merry_core_icall(MerryCore *core, msize_t index)
+{
+    if (surelyF(index >= _MERRY_INTR_COUNT_))
+    {
+        merry_requestHdlr_panic(MERRY_INVALID_INTRINSIC);
+        return RET_FAILURE;
+    }
+    if (surelyF(merry_intrinsic_call(index, core->data_mem, core->registers) == RET_FAILURE))
+    {
+        merry_requestHdlr_panic(core->data_mem->error);
+        return RET_FAILURE;
+    }
+    return RET_SUCCESS;
+}
+
+msize_t merry_core_run(MerryCore *c, msize_t quantum)
 {
-    MerryCore *c = (MerryCore *)core;
     register mqptr_t current = &c->current_inst;
     register mqword_t curr = 0;
     while (mtrue)
@@ -109,8 +323,10 @@ _THRET_T_ merry_runCore(mptr_t core)
         if (c->stop_running == mtrue)
         {
             // _llog_(_CORE_, "STOPPING", "Core ID %lu stopping now", c->core_id);
-            break;
+            return _MERRY_CORE_STOPPED_;
         }
+        if (surelyF(quantum-- == 0))
+            return _MERRY_CORE_PREEMPTED_; // give the other cores on this worker a turn
         // merry_mutex_unlock(c->lock);
         if (merry_manager_mem_read_inst(c->inst_mem, c->pc, current) == RET_FAILURE)
         {
@@ -118,14 +334,15 @@ _THRET_T_ merry_runCore(mptr_t core)
             // _llog_(_DECODER_, "DECODE_FAILED", "Decoding failed; Memory read failed", c->core_id);
             merry_requestHdlr_panic(c->inst_mem->error);
             /// TODO: Replace all of these types of statements with atomic operations instead.
-            break; // stay out of it
+            return _MERRY_CORE_STOPPED_; // stay out of it
         }
         switch (merry_get_opcode(*current))
         {
         case OP_NOP: // we don't care about NOP instructions
             break;
         case OP_HALT: // Simply stop the core
-            merry_requestHdlr_push_request(_REQ_REQHALT, c->core_id, c->cond);
+            merry_out_flush(&c->out);
+            merry_core_request(c, _REQ_REQHALT);
             c->stop_running = mtrue;
             break;
         // Please ignore all of the redundant code
@@ -525,7 +742,37 @@ _THRET_T_ merry_runCore(mptr_t core)
             }
             break;
         case OP_INTR:
-            if (merry_requestHdlr_push_request(*current & 0xFFFF, c->core_id, c->cond) == RET_FAILURE)
+            // the request may print something itself or end the program and so what we have must come out first
+            merry_out_flush(&c->out);
+            if (merry_core_request(c, *current & 0xFFFF) == RET_FAILURE)
+                c->stop_running = mtrue;
+            break;
+        case OP_AINTR:
+            merry_out_flush(&c->out);
+            if (merry_core_async_submit(c, *current & 0xFFFF) == RET_FAILURE)
+                c->stop_running = mtrue;
+            break;
+        case OP_APOLL:
+            if (merry_core_async_collect(c, (*current >> 4) & 15, *current & 15, mfalse) == RET_FAILURE)
+                c->stop_running = mtrue;
+            break;
+        case OP_AWAIT:
+            if (merry_core_async_collect(c, *current & 15, *current & 15, mtrue) == RET_FAILURE)
+                c->stop_running = mtrue;
+            break;
+        case OP_NCALL:
+            // the slot is in Mb and the address of the parameter in Mc just like for the request
+            merry_out_flush(&c->out);
+            if (merry_core_ncall(c) == RET_FAILURE)
+                c->stop_running = mtrue;
+            break;
+        case OP_FLUSH:
+            merry_out_flush(&c->out);
+            fflush(stdout);
+            break;
+        case OP_ICALL:
+            // the intrinsic's index is in the lower 2 bytes and it runs right here
+            if (merry_core_icall(c, *current & 0xFFFF) == RET_FAILURE)
                 c->stop_running = mtrue;
             break;
         case OP_CMPXCHG:
@@ -534,7 +781,7 @@ _THRET_T_ merry_runCore(mptr_t core)
             // this instruction will take a 6-byte address and 2 registers
             // this works for 1 byte only
             {
-                mqptr_t _addr_ = merry_dmemory_get_qword_address(c->data_mem, *current & 0xFFFFFFFFFFFF);
+                mqptr_t _addr_ = merry_dmemory_get_qword_address_store(c->data_mem, *current & 0xFFFFFFFFFFFF, 0);
                 if (_addr_ == RET_NULL)
                 {
                     merry_requestHdlr_panic(c->data_mem->error);
@@ -546,28 +793,37 @@ _THRET_T_ merry_runCore(mptr_t core)
             break;
         case OP_CIN:
             // the input is stored in a register that is encoded into the last 4 bits of the instruction
-            c->registers[*current & 15] = getchar();
+            // anything waiting to be printed is printed first as it may be a prompt for this input
+            merry_out_flush(&c->out);
+            if (merry_core_enter_host(c) == RET_FAILURE)
+                break;
+            {
+                mqword_t ch = merry_in_char();
+                merry_core_leave_host(c);
+                c->registers[*current & 15] = ch;
+            }
             break;
         case OP_COUT:
             // the byte to output is stored in a register that is encoded into the last 4 bits of the instruction
-            putchar((int)c->registers[*current & 15]);
+            merry_out_byte(&c->out, (char)c->registers[*current & 15]);
             break;
         case OP_SIN:
             // the address to store in is encoded into the instruction
             // the number of bytes to input is in the Mc register
             {
                 register mqword_t len = c->registers[Mc];
-                mbptr_t _addr_ = merry_dmemory_get_byte_address_bounds(c->data_mem, *current & 0xFFFFFFFFFFFF, len);
+                mbptr_t _addr_ = merry_dmemory_get_byte_address_store(c->data_mem, *current & 0xFFFFFFFFFFFF, len);
                 if (_addr_ == RET_NULL)
                 {
                     merry_requestHdlr_panic(c->data_mem->error);
                     c->stop_running = mtrue;
                     break;
                 }
-                for (msize_t i = 0; i < len; i++, _addr_++)
-                {
-                    *_addr_ = getchar();
-                }
+                merry_out_flush(&c->out);
+                if (merry_core_enter_host(c) == RET_FAILURE)
+                    break;
+                merry_in_bytes(_addr_, len);
+                merry_core_leave_host(c);
             }
             break;
         case OP_SOUT:
@@ -582,91 +838,133 @@ _THRET_T_ merry_runCore(mptr_t core)
                     c->stop_running = mtrue;
                     break;
                 }
-                for (msize_t i = 0; i < len; i++, _addr_++)
-                {
-                    putchar(*_addr_);
-                }
+                merry_out_write(&c->out, _addr_, len);
             }
             break;
         case OP_IN:
-            fscanf(stdin, "%hhi", &c->registers[*current & 15]);
+            merry_core_read_integer(c, *current & 15, 1, mtrue);
             break;
         case OP_OUT:
-            fprintf(stdout, "%hhi", c->registers[*current & 15]);
+            merry_out_signed(&c->out, (signed char)c->registers[*current & 15]);
             break;
         case OP_INW:
             // same as OP_IN, store in a register
-            fscanf(stdin, "%hd", &c->registers[*current & 15]);
+            merry_core_read_integer(c, *current & 15, 2, mfalse);
             break;
         case OP_OUTW:
             // same as OP_OUT, stored in a register
-            fprintf(stdout, "%hd", c->registers[*current & 15]);
+            merry_out_signed(&c->out, (short)c->registers[*current & 15]);
             break;
         case OP_IND:
-            fscanf(stdin, "%d", &c->registers[*current & 15]);
+            merry_core_read_integer(c, *current & 15, 4, mfalse);
             break;
         case OP_OUTD:
-            fprintf(stdout, "%d", c->registers[*current & 15]);
+            merry_out_signed(&c->out, (int)c->registers[*current & 15]);
             break;
         case OP_INQ:
-            fscanf(stdin, "%lld", &c->registers[*current & 15]);
+            merry_core_read_integer(c, *current & 15, 8, mfalse);
             break;
         case OP_OUTQ:
-            fprintf(stdout, "%lld", c->registers[*current & 15]);
+            merry_out_signed(&c->out, (msqword_t)c->registers[*current & 15]);
             break;
         case OP_UIN:
-            fscanf(stdin, "%hhu", &c->registers[*current & 15]);
+            merry_core_read_integer(c, *current & 15, 1, mfalse);
             break;
         case OP_UOUT:
-            fprintf(stdout, "%hhu", c->registers[*current & 15]);
+            merry_out_unsigned(&c->out, (mbyte_t)c->registers[*current & 15]);
             break;
         case OP_UINW:
             // same as OP_IN, store in a register
-            fscanf(stdin, "%hu", &c->registers[*current & 15]);
+            merry_core_read_integer(c, *current & 15, 2, mfalse);
             break;
         case OP_UOUTW:
             // same as OP_OUT, stored in a register
-            fprintf(stdout, "%hu", c->registers[*current & 15]);
+            merry_out_unsigned(&c->out, (mword_t)c->registers[*current & 15]);
             break;
         case OP_UIND:
-            fscanf(stdin, "%d", &c->registers[*current & 15]);
+            merry_core_read_integer(c, *current & 15, 4, mfalse);
             break;
         case OP_UOUTD:
-            fprintf(stdout, "%u", c->registers[*current & 15]);
+            merry_out_unsigned(&c->out, (mdword_t)c->registers[*current & 15]);
             break;
         case OP_UINQ:
-            fscanf(stdin, "%llu", &c->registers[*current & 15]);
+            merry_core_read_integer(c, *current & 15, 8, mfalse);
             break;
         case OP_UOUTQ:
-            fprintf(stdout, "%llu", c->registers[*current & 15]);
+            merry_out_unsigned(&c->out, c->registers[*current & 15]);
             break;
         case OP_INF:
-            fscanf(stdin, "%lf", &c->registers[*current & 15]);
+            merry_core_read_float(c, *current & 15, mfalse);
             break;
         case OP_OUTF:
-            fprintf(stdout, "%lf", c->registers[*current & 15]);
+            // the register has the bits of the double that INF read and they must be handed over as one
+            {
+                double _f_;
+                memcpy(&_f_, &c->registers[*current & 15], sizeof(_f_));
+                merry_out_double(&c->out, _f_);
+            }
             break;
         case OP_INF32:
-            fscanf(stdin, "%f", &c->registers[*current & 15]);
+            merry_core_read_float(c, *current & 15, mtrue);
             break;
         case OP_OUTF32:
-            fprintf(stdout, "%f", c->registers[*current & 15]);
+            {
+                float _f_;
+                memcpy(&_f_, &c->registers[*current & 15], sizeof(_f_));
+                merry_out_double(&c->out, (double)_f_);
+            }
             break;
         case OP_OUTR:
             for (msize_t i = 0; i < REGR_COUNT; i++)
-                fprintf(stdout, "%lli\n", c->registers[i]);
+            {
+                merry_out_signed(&c->out, (msqword_t)c->registers[i]);
+                merry_out_byte(&c->out, '\n');
+            }
             break;
         case OP_UOUTR:
             for (msize_t i = 0; i < REGR_COUNT; i++)
-                fprintf(stdout, "%llu\n", c->registers[i]);
+            {
+                merry_out_unsigned(&c->out, c->registers[i]);
+                merry_out_byte(&c->out, '\n');
+            }
             break;
         }
         c->pc++;
+        if (surelyF(c->blocked_on != RET_NULL))
+            return _MERRY_CORE_BLOCKED_; // the scheduler runs the core again once the request is done
+    }
+}
+
+_THRET_T_ merry_runCore(mptr_t core)
+{
+    MerryCore *c = (MerryCore *)core;
+    while (mtrue)
+    {
+        merry_core_run(c, _MERRY_CORE_FOREVER_);
+        merry_out_flush(&c->out); // whatever is left
+        // the core goes back to the Manager and we wait with it so that giving it out again is only a wake up
+        merry_mutex_lock(c->lock);
+        atomic_store(&c->run_state, _MERRY_CORE_DONE_);
+        if (merry_os_core_done(c) == mtrue)
+        {
+            while (atomic_load(&c->run_state) == _MERRY_CORE_DONE_ && c->retired == mfalse)
+                merry_cond_wait(c->cond, c->lock);
+        }
+        mbool_t again = atomic_load(&c->run_state) == _MERRY_CORE_RUNNING_;
+        merry_mutex_unlock(c->lock);
+        if (again == mfalse)
+            break;
     }
+    mqword_t ret = c->registers[Ma];
+    // the last time we touch the core as it may be freed as soon as we let go of the lock
+    merry_mutex_lock(c->lock);
+    atomic_store(&c->run_state, _MERRY_CORE_RETIRED_);
+    merry_cond_broadcast(c->cond);
+    merry_mutex_unlock(c->lock);
 // printf("Ma is now %lu\n", c->registers[Ma]); // 1,000,000,000
 #if defined(_MERRY_HOST_OS_LINUX_)
-    return (mptr_t)c->registers[Ma];
+    return (mptr_t)ret;
 #elif defined(_MERRY_HOST_OS_WINDOWS_)
-    return c->registers[Ma];
+    return ret;
 #endif
 }
@@ -24,6 +24,7 @@ _MERRY_INTERNAL_ MerryDMemPage *merry_mem_allocate_new_mempage()
     new_page->address_wspace = (mwptr_t)new_page->address_space;
     new_page->address_dspace = (mdptr_t)new_page->address_space;
     new_page->address_qspace = (mqptr_t)new_page->address_space;
+    atomic_init(&new_page->read_only, mfalse);
     // everything went successfully
     return new_page;
 }
@@ -48,6 +49,7 @@ _MERRY_INTERNAL_ MerryDMemPage *merry_mem_allocate_new_mempage_provided(mqptr_t
     new_page->address_wspace = (mwptr_t)new_page->address_space;
     new_page->address_dspace = (mdptr_t)new_page->address_space;
     new_page->address_qspace = (mqptr_t)new_page->address_space;
+    atomic_init(&new_page->read_only, mfalse);
     // everything went successfully
     // _log_(_MEM_, "Page Allocation", "Allocating memory provided");
     return new_page;
@@ -188,6 +190,12 @@ mret_t merry_dmemory_write_byte(MerryDMemory *memory, maddress_t address, mqword
         memory->error = MERRY_MEM_INVALID_ACCESS;
         return RET_FAILURE;
     }
+    if (surelyF(_MERRY_DMEMORY_READ_ONLY_(memory->pages[addr.page])))
+    {
+        // a file is mapped here read-only
+        memory->error = MERRY_MEM_READ_ONLY;
+        return RET_FAILURE;
+    }
     memory->pages[addr.page]->address_space[addr.offset] = _to_write;
     return RET_SUCCESS;
 }
@@ -236,6 +244,12 @@ mret_t merry_dmemory_write_word(MerryDMemory *memory, maddress_t address, mqword
         memory->error = MERRY_MEM_INVALID_ACCESS;
         return RET_FAILURE;
     }
+    if (surelyF(_MERRY_DMEMORY_READ_ONLY_(memory->pages[addr.page])))
+    {
+        // a file is mapped here read-only
+        memory->error = MERRY_MEM_READ_ONLY;
+        return RET_FAILURE;
+    }
     memory->pages[addr.page]->address_wspace[addr.offset / 2] = _to_write & 0xFFFF;
     // #if _MERRY_BYTE_ORDER_ == _MERRY_LITTLE_ENDIAN_
     //     // *_store_in = memory->pages[addr.page]->address_space[addr.offset + 1];
@@ -297,6 +311,12 @@ mret_t merry_dmemory_write_dword(MerryDMemory *memory, maddress_t address, mqwor
         memory->error = MERRY_MEM_INVALID_ACCESS;
         return RET_FAILURE;
     }
+    if (surelyF(_MERRY_DMEMORY_READ_ONLY_(memory->pages[addr.page])))
+    {
+        // a file is mapped here read-only
+        memory->error = MERRY_MEM_READ_ONLY;
+        return RET_FAILURE;
+    }
     memory->pages[addr.page]->address_wspace[addr.offset / 4] = _to_write & 0xFFFFFFFF;
     // #if _MERRY_BYTE_ORDER_ == _MERRY_LITTLE_ENDIAN_
     //     // *_store_in = memory->pages[addr.page]->address_space[addr.offset + 1];
@@ -369,6 +389,12 @@ mret_t merry_dmemory_write_qword(MerryDMemory *memory, maddress_t address, mqwor
         memory->error = MERRY_MEM_INVALID_ACCESS;
         return RET_FAILURE;
     }
+    if (surelyF(_MERRY_DMEMORY_READ_ONLY_(memory->pages[addr.page])))
+    {
+        // a file is mapped here read-only
+        memory->error = MERRY_MEM_READ_ONLY;
+        return RET_FAILURE;
+    }
     memory->pages[addr.page]->address_wspace[addr.offset / 8] = _to_write;
     // #if _MERRY_BYTE_ORDER_ == _MERRY_LITTLE_ENDIAN_
     //     // *_store_in = memory->pages[addr.page]->address_space[addr.offset + 1];
@@ -464,6 +490,19 @@ mbptr_t merry_dmemory_get_byte_address_bounds(MerryDMemory *memory, maddress_t a
     return &memory->pages[addr.page]->address_space[addr.offset];
 }
 
+mbptr_t merry_dmemory_get_byte_address_store(MerryDMemory *memory, maddress_t address, msize_t bound)
+{
+    mbptr_t addr = merry_dmemory_get_byte_address_bounds(memory, address, bound);
+    if (addr == RET_NULL)
+        return RET_NULL;
+    if (surelyF(_MERRY_DMEMORY_READ_ONLY_(memory->pages[address / _MERRY_MEMORY_ADDRESSES_PER_PAGE_])))
+    {
+        memory->error = MERRY_MEM_READ_ONLY;
+        return RET_NULL;
+    }
+    return addr;
+}
+
 mwptr_t merry_dmemory_get_word_address(MerryDMemory *memory, maddress_t address)
 {
     register MerryDAddress addr = _MERRY_DMEMORY_DEDUCE_ADDRESS_(address);
@@ -562,3 +601,114 @@ mqptr_t merry_dmemory_get_qword_address_bounds(MerryDMemory *memory, maddress_t
     // this just basically returns an actual address to the address that the manager can use
     return &memory->pages[addr.page]->address_qspace[addr.offset / 8];
 }
+
+mqptr_t merry_dmemory_get_qword_address_store(MerryDMemory *memory, maddress_t address, msize_t bound)
+{
+    mqptr_t addr = merry_dmemory_get_qword_address_bounds(memory, address, bound);
+    if (addr == RET_NULL)
+        return RET_NULL;
+    if (surelyF(_MERRY_DMEMORY_READ_ONLY_(memory->pages[address / _MERRY_MEMORY_ADDRESSES_PER_PAGE_])))
+    {
+        memory->error = MERRY_MEM_READ_ONLY;
+        return RET_NULL;
+    }
+    return addr;
+}
+
+mret_t merry_dmemory_get_span(MerryDMemory *memory, maddress_t address, msize_t len, mbool_t store, MerryIOVec *iov, msize_t max, msize_t *count)
+{
+    // one buffer for every page that the span touches since the pages aren't next to each other on the host
+    register MerryDAddress addr = _MERRY_DMEMORY_DEDUCE_ADDRESS_(address);
+    msize_t i = 0;
+    msize_t offset = addr.offset;
+    for (msize_t page = addr.page; len > 0; page++, i++, offset = 0)
+    {
+        if (surelyF(page >= memory->number_of_pages))
+        {
+            memory->error = MERRY_MEM_INVALID_ACCESS;
+            return RET_FAILURE;
+        }
+        if (surelyF(i == max))
+        {
+            memory->error = MERRY_INVALID_IOV;
+            return RET_FAILURE;
+        }
+        if (surelyF(store == mtrue && _MERRY_DMEMORY_READ_ONLY_(memory->pages[page])))
+        {
+            memory->error = MERRY_MEM_READ_ONLY;
+            return RET_FAILURE;
+        }
+        msize_t in_page = _MERRY_MEMORY_ADDRESSES_PER_PAGE_ - offset;
+        iov[i].iov_base = &memory->pages[page]->address_space[offset];
+        iov[i].iov_len = (len < in_page) ? len : in_page;
+        len -= iov[i].iov_len;
+    }
+    *count = i;
+    return RET_SUCCESS;
+}
+
+mret_t merry_dmemory_map_file(MerryDMemory *memory, maddress_t address, msize_t len, int fd, mqword_t offset, msize_t file_len, mbool_t read_only)
+{
+#if _MERRY_MEM_FILE_MAP_SUPPORT_
+    // the pages stay where they are on the host and the file is mapped right over them
+    // that way no one has to be told about it and every core sees the file the moment it is there
+    register MerryDAddress addr = _MERRY_DMEMORY_DEDUCE_ADDRESS_(address);
+    msize_t page_count = (len + _MERRY_MEMORY_ADDRESSES_PER_PAGE_ - 1) / _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
+    msize_t host_page = _MERRY_MEM_HOST_PAGE_SIZE_;
+    if (addr.offset != 0 || len == 0 || addr.page + page_count > memory->number_of_pages || offset % host_page != 0 || file_len > len)
+    {
+        memory->error = MERRY_MEM_INVALID_ACCESS;
+        return RET_FAILURE;
+    }
+    for (msize_t i = 0; i < page_count; i++)
+    {
+        MerryDMemPage *page = memory->pages[addr.page + i];
+        // how much of this page comes from the file; the rest is zeroed as the file might not fill it
+        msize_t from_file = (file_len > i * _MERRY_MEMORY_ADDRESSES_PER_PAGE_) ? file_len - i * _MERRY_MEMORY_ADDRESSES_PER_PAGE_ : 0;
+        if (from_file > _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
+            from_file = _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
+        from_file = (from_file + host_page - 1) / host_page * host_page; // the host fills what is past the file's end with zeroes
+        if ((from_file != 0 && _MERRY_MEM_MAP_FILE_FIXED_(page->address_space, from_file, fd, offset + i * _MERRY_MEMORY_ADDRESSES_PER_PAGE_) == _MERRY_RET_GET_ERROR_) ||
+            (from_file != _MERRY_MEMORY_ADDRESSES_PER_PAGE_ && _MERRY_MEM_MAP_ZERO_FIXED_(page->address_space + from_file, _MERRY_MEMORY_ADDRESSES_PER_PAGE_ - from_file) == _MERRY_RET_GET_ERROR_))
+        {
+            // the pages before this one have the file and this one may have a part of it
+            // what was there before is gone already and so the best we can do is not leave a half mapped file behind
+            merry_dmemory_unmap(memory, address, (i + 1) * _MERRY_MEMORY_ADDRESSES_PER_PAGE_);
+            memory->error = MERRY_MEM_INVALID_ACCESS;
+            return RET_FAILURE;
+        }
+        atomic_store(&page->read_only, read_only);
+    }
+    return RET_SUCCESS;
+#else
+    memory->error = MERRY_MEM_INVALID_ACCESS;
+    return RET_FAILURE;
+#endif
+}
+
+mret_t merry_dmemory_unmap(MerryDMemory *memory, maddress_t address, msize_t len)
+{
+#if _MERRY_MEM_FILE_MAP_SUPPORT_
+    register MerryDAddress addr = _MERRY_DMEMORY_DEDUCE_ADDRESS_(address);
+    msize_t page_count = (len + _MERRY_MEMORY_ADDRESSES_PER_PAGE_ - 1) / _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
+    if (addr.offset != 0 || len == 0 || addr.page + page_count > memory->number_of_pages)
+    {
+        memory->error = MERRY_MEM_INVALID_ACCESS;
+        return RET_FAILURE;
+    }
+    for (msize_t i = 0; i < page_count; i++)
+    {
+        MerryDMemPage *page = memory->pages[addr.page + i];
+        if (_MERRY_MEM_MAP_ZERO_FIXED_(page->address_space, _MERRY_MEMORY_ADDRESSES_PER_PAGE_) == _MERRY_RET_GET_ERROR_)
+        {
+            memory->error = MERRY_MEM_INVALID_ACCESS;
+            return RET_FAILURE;
+        }
+        atomic_store(&page->read_only, mfalse);
+    }
+    return RET_SUCCESS;
+#else
+    memory->error = MERRY_MEM_INVALID_ACCESS;
+    return RET_FAILURE;
+#endif
+}
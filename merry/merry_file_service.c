@@ -0,0 +1,184 @@
+#include "internals/merry_file_service.h"
+#include "internals/merry_core.h" // for the registers
+
+#define _MERRY_FSERV_STOP_ (~0ULL) // the user data of the entry that stops the reaper
+
+_MERRY_INTERNAL_ void merry_file_service_finish(MerryFileService *fserv, MerryFileOp *op, msize_t done)
+{
+    if (op->claimed == mtrue)
+        merry_file_settle(op->file, op->offset, op->len, done, op->request.request_number == _REQ_FREAD);
+    op->request.regs[Ma] = done; // the number of bytes read or written
+    fserv->done(&op->request);
+    // the pool may be waiting to do what comes after this on the file
+    merry_file_dequeue(op->file);
+    merry_file_drop(op->file);
+    atomic_store_explicit(&op->busy, mfalse, memory_order_release);
+    if (atomic_fetch_sub(&fserv->in_flight, 1) == 1 && atomic_load(&fserv->draining) == mtrue)
+    {
+        merry_mutex_lock(fserv->lock);
+        merry_cond_signal(fserv->cond);
+        merry_mutex_unlock(fserv->lock);
+    }
+}
+
+_MERRY_INTERNAL_ _THRET_T_ merry_file_service_reap(mptr_t arg)
+{
+    MerryFileService *fserv = (MerryFileService *)arg;
+    mqword_t user_data;
+    msqword_t res;
+    while (merry_uring_wait(fserv->ring, &user_data, &res) == RET_SUCCESS)
+    {
+        if (user_data == _MERRY_FSERV_STOP_)
+            break;
+        merry_file_service_finish(fserv, &fserv->ops[user_data], (res < 0) ? 0 : (msize_t)res);
+    }
+#if defined(_MERRY_HOST_OS_LINUX_)
+    return RET_NULL;
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+    return 0;
+#endif
+}
+
+MerryFileService *merry_file_service_init(msize_t op_count, merry_fserv_done_t done)
+{
+    MerryURing *ring = merry_uring_init(op_count);
+    if (ring == RET_NULL)
+        return RET_NULL; // no io_uring
+    MerryFileService *fserv = (MerryFileService *)malloc(sizeof(MerryFileService));
+    if (fserv == NULL)
+    {
+        merry_uring_destroy(ring);
+        return RET_NULL;
+    }
+    fserv->ring = ring;
+    fserv->op_count = op_count;
+    fserv->next_op = 0;
+    fserv->done = done;
+    fserv->ops = NULL;
+    fserv->lock = RET_NULL;
+    fserv->cond = RET_NULL;
+    atomic_init(&fserv->in_flight, 0);
+    atomic_init(&fserv->draining, mfalse);
+    if ((fserv->lock = merry_mutex_init()) == RET_NULL || (fserv->cond = merry_cond_init()) == RET_NULL)
+        goto failure;
+    if ((fserv->ops = (MerryFileOp *)calloc(op_count, sizeof(MerryFileOp))) == NULL)
+        goto failure;
+    for (msize_t i = 0; i < op_count; i++)
+        atomic_init(&fserv->ops[i].busy, mfalse);
+    if ((fserv->reaper = merry_thread_init()) == RET_NULL)
+        goto failure;
+    if (merry_create_thread(fserv->reaper, &merry_file_service_reap, fserv) == RET_FAILURE)
+    {
+        merry_thread_destroy(fserv->reaper);
+        goto failure;
+    }
+    return fserv;
+failure:
+    merry_mutex_destroy(fserv->lock);
+    merry_cond_destroy(fserv->cond);
+    free(fserv->ops);
+    merry_uring_destroy(ring);
+    free(fserv);
+    return RET_NULL;
+}
+
+_MERRY_INTERNAL_ MerryFileOp *merry_file_service_get_op(MerryFileService *fserv, msize_t *index)
+{
+    for (msize_t i = 0; i < fserv->op_count; i++)
+    {
+        msize_t ind = (fserv->next_op + i) % fserv->op_count;
+        if (atomic_load_explicit(&fserv->ops[ind].busy, memory_order_acquire) == mfalse)
+        {
+            fserv->next_op = ind + 1;
+            *index = ind;
+            return &fserv->ops[ind];
+        }
+    }
+    return RET_NULL;
+}
+
+mret_t merry_file_service_prep(MerryFileService *fserv, MerryOSRequest *request, MerryFile *file, MerryIOVec *iov, msize_t count, mqword_t offset)
+{
+    msize_t index;
+    if (count > _MERRY_FSERV_IOV_MAX_)
+        return RET_FAILURE;
+    MerryFileOp *op = merry_file_service_get_op(fserv, &index);
+    if (op == RET_NULL)
+        return RET_FAILURE; // too much in flight already
+    mbyte_t uring_op = (request->request_number == _REQ_FREAD || request->request_number == _REQ_FPREAD) ? _MERRY_URING_READV_ : _MERRY_URING_WRITEV_;
+    msize_t len = 0;
+    for (msize_t i = 0; i < count; i++)
+    {
+        op->iov[i] = iov[i];
+        len += iov[i].iov_len;
+    }
+    op->count = count;
+    mbool_t claimed = offset == _MERRY_FILE_CUR_POS_;
+    if (claimed == mtrue)
+        offset = merry_file_claim(file, len);
+    if (merry_uring_prep(fserv->ring, uring_op, file->fd, op->iov, count, offset, index) == RET_FAILURE)
+    {
+        // the submission ring is full and so submit what is there to make room
+        merry_file_service_flush(fserv);
+        if (merry_uring_prep(fserv->ring, uring_op, file->fd, op->iov, count, offset, index) == RET_FAILURE)
+        {
+            if (claimed == mtrue)
+                merry_file_settle(file, offset, len, 0, mfalse);
+            return RET_FAILURE;
+        }
+    }
+    op->request = *request;
+    op->file = file;
+    op->offset = offset;
+    op->len = len;
+    op->claimed = claimed;
+    merry_file_queue(file);
+    atomic_store_explicit(&op->busy, mtrue, memory_order_relaxed);
+    atomic_fetch_add(&fserv->in_flight, 1);
+    // the Manager flushes when it runs out of requests but a busy queue mustn't hold back what was prepared forever
+    if (fserv->ring->to_submit >= _MERRY_FSERV_BATCH_)
+        merry_file_service_flush(fserv);
+    return RET_SUCCESS;
+}
+
+void merry_file_service_flush(MerryFileService *fserv)
+{
+    if (merry_uring_submit(fserv->ring) == RET_SUCCESS)
+        return;
+    // the cores waiting on these would never wake up and so we take them back and do them ourselves
+    mqword_t index;
+    while (merry_uring_unprep(fserv->ring, &index) == RET_SUCCESS)
+    {
+        if (index == _MERRY_FSERV_STOP_)
+            continue;
+        MerryFileOp *op = &fserv->ops[index];
+        mbool_t is_read = op->request.request_number == _REQ_FREAD || op->request.request_number == _REQ_FPREAD;
+        // the offset was claimed already if it had to be
+        msize_t done = (is_read == mtrue) ? merry_file_read(op->file, op->iov, op->count, op->offset) : merry_file_write(op->file, op->iov, op->count, op->offset);
+        merry_file_service_finish(fserv, op, done);
+    }
+}
+
+void merry_file_service_destroy(MerryFileService *fserv)
+{
+    if (fserv == NULL)
+        return;
+    // the entries complete in any order and so the reaper is only told to stop once nothing is in flight
+    atomic_store(&fserv->draining, mtrue);
+    merry_file_service_flush(fserv);
+    merry_mutex_lock(fserv->lock);
+    while (atomic_load(&fserv->in_flight) > 0)
+        merry_cond_wait(fserv->cond, fserv->lock);
+    merry_mutex_unlock(fserv->lock);
+    // the kernel took everything and so there is room
+    merry_uring_prep(fserv->ring, _MERRY_URING_NOP_, -1, NULL, 0, 0, _MERRY_FSERV_STOP_);
+    if (merry_uring_submit(fserv->ring) == RET_FAILURE)
+        return; // the reaper can't be told to stop and so it is left asleep along with everything it uses
+    merry_thread_join(fserv->reaper, NULL);
+    merry_thread_destroy(fserv->reaper);
+    merry_uring_destroy(fserv->ring);
+    merry_mutex_destroy(fserv->lock);
+    merry_cond_destroy(fserv->cond);
+    free(fserv->ops);
+    free(fserv);
+}
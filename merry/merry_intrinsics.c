@@ -0,0 +1,254 @@
+#include "internals/merry_intrinsics.h"
+#include "internals/merry_core.h" // for the registers
+
+#define _MERRY_INTR_FUNC_(id, name, function) &function,
+_MERRY_INTERNAL_ merry_intr_t intrinsics[] = {_MERRY_INTRINSICS_(_MERRY_INTR_FUNC_)};
+#undef _MERRY_INTR_FUNC_
+
+#define _MERRY_INTR_NAME_(id, name, function) #name,
+_MERRY_INTERNAL_ mcstr_t intrinsic_names[] = {_MERRY_INTRINSICS_(_MERRY_INTR_NAME_)};
+#undef _MERRY_INTR_NAME_
+
+// The part of [address, address + len) that lies in the page that address is in
+// Every page is mapped on its own and so nothing may ever run past the end of a page
+_MERRY_INTERNAL_ mbptr_t merry_intr_piece(MerryDMemory *memory, maddress_t address, msize_t len, mbool_t store, msize_t *piece)
+{
+    MerryDAddress addr = _MERRY_DMEMORY_DEDUCE_ADDRESS_(address);
+    *piece = 0; // nothing on failure
+    if (surelyF(addr.page >= memory->number_of_pages))
+    {
+        memory->error = MERRY_MEM_INVALID_ACCESS;
+        return RET_NULL;
+    }
+    if (store == mtrue && _MERRY_DMEMORY_READ_ONLY_(memory->pages[addr.page]))
+    {
+        memory->error = MERRY_MEM_READ_ONLY;
+        return RET_NULL;
+    }
+    msize_t left = _MERRY_MEMORY_ADDRESSES_PER_PAGE_ - addr.offset;
+    *piece = len < left ? len : left;
+    return memory->pages[addr.page]->address_space + addr.offset;
+}
+
+// the same but for the part that ends right before end
+_MERRY_INTERNAL_ mbptr_t merry_intr_piece_before(MerryDMemory *memory, maddress_t end, msize_t len, mbool_t store, msize_t *piece)
+{
+    maddress_t address = end - 1;
+    MerryDAddress addr = _MERRY_DMEMORY_DEDUCE_ADDRESS_(address);
+    *piece = 0; // nothing on failure
+    if (surelyF(addr.page >= memory->number_of_pages))
+    {
+        memory->error = MERRY_MEM_INVALID_ACCESS;
+        return RET_NULL;
+    }
+    if (store == mtrue && _MERRY_DMEMORY_READ_ONLY_(memory->pages[addr.page]))
+    {
+        memory->error = MERRY_MEM_READ_ONLY;
+        return RET_NULL;
+    }
+    *piece = len < addr.offset + 1 ? len : addr.offset + 1;
+    return memory->pages[addr.page]->address_space + addr.offset + 1 - *piece;
+}
+
+// copy at most len bytes of the string at address into buf and terminate it
+_MERRY_INTERNAL_ mret_t merry_intr_get_str(MerryDMemory *memory, maddress_t address, char *buf, msize_t len)
+{
+    msize_t got = 0, piece;
+    while (got < len - 1)
+    {
+        mbptr_t from = merry_intr_piece(memory, address + got, len - 1 - got, mfalse, &piece);
+        if (from == RET_NULL)
+        {
+            // the string may well end right before an unmapped page
+            if (got > 0)
+                break;
+            return RET_FAILURE;
+        }
+        mbptr_t nul = memchr(from, 0, piece);
+        if (nul != NULL)
+            piece = nul - from;
+        memcpy(buf + got, from, piece);
+        got += piece;
+        if (nul != NULL)
+            break;
+    }
+    buf[got] = 0;
+    return RET_SUCCESS;
+}
+
+mret_t merry_intr_memcpy(MerryDMemory *memory, mqptr_t regs)
+{
+    // Mb = destination, Mc = source, Md = number of bytes; the two may overlap
+    maddress_t dest = regs[Mb], src = regs[Mc];
+    msize_t len = regs[Md], pd, ps;
+    if (dest == src || len == 0)
+        return RET_SUCCESS;
+    if (dest < src || dest >= src + len)
+    {
+        while (len > 0)
+        {
+            mbptr_t to = merry_intr_piece(memory, dest, len, mtrue, &pd);
+            mbptr_t from = merry_intr_piece(memory, src, len, mfalse, &ps);
+            if (to == RET_NULL || from == RET_NULL)
+                return RET_FAILURE;
+            msize_t n = pd < ps ? pd : ps;
+            memmove(to, from, n);
+            dest += n;
+            src += n;
+            len -= n;
+        }
+        return RET_SUCCESS;
+    }
+    // the destination overlaps the end of the source and so the copy goes backwards
+    dest += len;
+    src += len;
+    while (len > 0)
+    {
+        mbptr_t to = merry_intr_piece_before(memory, dest, len, mtrue, &pd);
+        mbptr_t from = merry_intr_piece_before(memory, src, len, mfalse, &ps);
+        if (to == RET_NULL || from == RET_NULL)
+            return RET_FAILURE;
+        msize_t n = pd < ps ? pd : ps;
+        memmove(to + pd - n, from + ps - n, n);
+        dest -= n;
+        src -= n;
+        len -= n;
+    }
+    return RET_SUCCESS;
+}
+
+mret_t merry_intr_memset(MerryDMemory *memory, mqptr_t regs)
+{
+    // Mb = destination, Mc = the byte, Md = number of bytes
+    maddress_t dest = regs[Mb];
+    msize_t len = regs[Md], piece;
+    while (len > 0)
+    {
+        mbptr_t to = merry_intr_piece(memory, dest, len, mtrue, &piece);
+        if (to == RET_NULL)
+            return RET_FAILURE;
+        memset(to, (int)(regs[Mc] & 0xFF), piece);
+        dest += piece;
+        len -= piece;
+    }
+    return RET_SUCCESS;
+}
+
+mret_t merry_intr_memcmp(MerryDMemory *memory, mqptr_t regs)
+{
+    // Mb and Mc are the two addresses and Md the number of bytes; Ma is -1, 0 or 1
+    maddress_t a = regs[Mb], b = regs[Mc];
+    msize_t len = regs[Md], pa, pb;
+    regs[Ma] = 0;
+    while (len > 0)
+    {
+        mbptr_t x = merry_intr_piece(memory, a, len, mfalse, &pa);
+        mbptr_t y = merry_intr_piece(memory, b, len, mfalse, &pb);
+        if (x == RET_NULL || y == RET_NULL)
+            return RET_FAILURE;
+        msize_t n = pa < pb ? pa : pb;
+        int res = memcmp(x, y, n);
+        if (res != 0)
+        {
+            regs[Ma] = res < 0 ? (mqword_t)-1 : 1;
+            break;
+        }
+        a += n;
+        b += n;
+        len -= n;
+    }
+    return RET_SUCCESS;
+}
+
+mret_t merry_intr_strlen(MerryDMemory *memory, mqptr_t regs)
+{
+    // Mb = the string's address; Ma = its length
+    maddress_t address = regs[Mb];
+    msize_t piece;
+    while (mtrue)
+    {
+        mbptr_t from = merry_intr_piece(memory, address, _MERRY_MEMORY_ADDRESSES_PER_PAGE_, mfalse, &piece);
+        if (from == RET_NULL)
+            return RET_FAILURE; // the string never ended
+        mbptr_t nul = memchr(from, 0, piece);
+        if (nul != NULL)
+        {
+            regs[Ma] = address + (nul - from) - regs[Mb];
+            return RET_SUCCESS;
+        }
+        address += piece;
+    }
+}
+
+mret_t merry_intr_strtol(MerryDMemory *memory, mqptr_t regs)
+{
+    // Mb = the string's address, Mc = the base(0 to guess it from the prefix like strtol does)
+    // Ma = the number and Md = the number of bytes that made it up(0 if there was no number at all)
+    char buf[_MERRY_INTR_STR_LEN_];
+    char *end;
+    if (merry_intr_get_str(memory, regs[Mb], buf, sizeof(buf)) == RET_FAILURE)
+        return RET_FAILURE;
+    if (regs[Mc] == 1 || regs[Mc] > 36)
+    {
+        regs[Ma] = 0;
+        regs[Md] = 0;
+        return RET_SUCCESS;
+    }
+    regs[Ma] = (mqword_t)strtoll(buf, &end, (int)regs[Mc]);
+    regs[Md] = end - buf;
+    return RET_SUCCESS;
+}
+
+mret_t merry_intr_strtod(MerryDMemory *memory, mqptr_t regs)
+{
+    // Mb = the string's address; Ma = the bits of the 64-bit floating point number and Md = the number of bytes that made it up
+    char buf[_MERRY_INTR_STR_LEN_];
+    char *end;
+    if (merry_intr_get_str(memory, regs[Mb], buf, sizeof(buf)) == RET_FAILURE)
+        return RET_FAILURE;
+    double value = strtod(buf, &end);
+    memcpy(&regs[Ma], &value, sizeof(value));
+    regs[Md] = end - buf;
+    return RET_SUCCESS;
+}
+
+mret_t merry_intr_clock_mono(MerryDMemory *memory, mqptr_t regs)
+{
+    // Ma = nanoseconds from some fixed point in the past; only good for measuring time
+    (void)memory;
+#if defined(_MERRY_HOST_OS_LINUX_)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    regs[Ma] = (mqword_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    regs[Ma] = (mqword_t)(count.QuadPart / freq.QuadPart) * 1000000000ULL + (mqword_t)(count.QuadPart % freq.QuadPart) * 1000000000ULL / freq.QuadPart;
+#endif
+    return RET_SUCCESS;
+}
+
+mret_t merry_intr_clock_real(MerryDMemory *memory, mqptr_t regs)
+{
+    // Ma = nanoseconds since the epoch
+    (void)memory;
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    regs[Ma] = (mqword_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    return RET_SUCCESS;
+}
+
+mret_t merry_intrinsic_call(msize_t index, MerryDMemory *memory, mqptr_t regs)
+{
+    if (surelyF(index >= _MERRY_INTR_COUNT_))
+        return RET_FAILURE;
+    return intrinsics[index](memory, regs);
+}
+
+mcstr_t merry_intrinsic_name(msize_t index)
+{
+    if (index >= _MERRY_INTR_COUNT_)
+        return RET_NULL;
+    return intrinsic_names[index];
+}
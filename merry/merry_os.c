@@ -2,6 +2,125 @@
 
 #include <stdatomic.h>
 
+// the pool fulfills the services with this
+_MERRY_INTERNAL_ void merry_os_service_request(MerryOSRequest *request);
+
+// hand the results over to the core and wake it up
+_MERRY_INTERNAL_ void merry_os_finish_request(MerryOSRequest *request);
+
+mret_t merry_os_set_placement(mcstr_t cpus, mbool_t numa, mbool_t interleave)
+{
+    MerryPlacement *place = &os.placement;
+    merry_topology_detect(&place->topo);
+    place->cpu_count = 0;
+    if (cpus != NULL && merry_topology_parse_cpus(&place->topo, cpus, place->cpus, _MERRY_MAX_CPUS_, &place->cpu_count) == RET_FAILURE)
+    {
+        fprintf(stderr, "Error: Invalid list of CPUs '%s'; The host has CPUs 0-%lu.\n", cpus, place->topo.cpu_count - 1);
+        return RET_FAILURE;
+    }
+    place->numa = numa;
+    place->interleave = interleave;
+    place->requested = mtrue;
+    return RET_SUCCESS;
+}
+
+mret_t merry_os_set_max_cores(msize_t count)
+{
+    if (count == 0 || count > _MERRY_MAX_CORES_LIMIT_)
+    {
+        fprintf(stderr, "Error: Invalid number of cores %lu; It must be from 1 to %d.\n", count, _MERRY_MAX_CORES_LIMIT_);
+        return RET_FAILURE;
+    }
+    os.max_cores = count;
+    return RET_SUCCESS;
+}
+
+mret_t merry_os_set_workers(msize_t count)
+{
+    if (count == 0 || count > _MERRY_SCHED_MAX_WORKERS_)
+    {
+        fprintf(stderr, "Error: Invalid number of workers %lu; It must be from 1 to %d.\n", count, _MERRY_SCHED_MAX_WORKERS_);
+        return RET_FAILURE;
+    }
+    os.worker_count = count;
+    return RET_SUCCESS;
+}
+
+_MERRY_INTERNAL_ void merry_os_report_placement()
+{
+    // what we found and what we did with it
+    MerryPlacement *place = &os.placement;
+    msize_t cpus[_MERRY_MAX_CPUS_];
+    fprintf(stderr, "Topology: %lu CPUs on %lu NUMA node(s)\n", place->topo.cpu_count, place->topo.node_count);
+    for (msize_t node = 0; node < place->topo.node_count; node++)
+    {
+        msize_t count = merry_topology_node_cpus(&place->topo, node, cpus, _MERRY_MAX_CPUS_);
+        if (count == 0)
+            continue;
+        fprintf(stderr, "    node %lu: CPUs ", node);
+        merry_topology_print_cpus(stderr, cpus, count);
+        fprintf(stderr, "\n");
+    }
+    // with the scheduler, it is the workers that are placed and the cores go wherever they are run
+    mcstr_t what = os.worker_count > 0 ? "Workers" : "Cores";
+    if (place->cpu_count > 0)
+    {
+        fprintf(stderr, "%s: pinned to CPUs ", what);
+        merry_topology_print_cpus(stderr, place->cpus, place->cpu_count);
+        fprintf(stderr, " in turn%s\n", (place->numa == mtrue && os.worker_count == 0) ? " with their stacks on the CPU's node" : "");
+    }
+    else if (place->numa == mtrue)
+        fprintf(stderr, "%s: kept on the NUMA nodes in turn%s\n", what, os.worker_count == 0 ? " with their stacks" : "");
+    else
+        fprintf(stderr, "%s: not pinned\n", what);
+    fprintf(stderr, "Data memory: %s\n", place->interleave == mtrue ? "interleaved over every node" : "on the node that first touches it");
+}
+
+_MERRY_INTERNAL_ void merry_os_place_memory()
+{
+    if (os.placement.interleave == mfalse)
+        return;
+    for (msize_t i = 0; i < os.data_mem->number_of_pages; i++)
+    {
+        if (merry_topology_interleave(&os.placement.topo, os.data_mem->pages[i]->address_space, _MERRY_MEMORY_ADDRESSES_PER_PAGE_) == RET_FAILURE)
+        {
+            fprintf(stderr, "Warning: Failed to interleave the data memory; it is left where it is.\n");
+            return;
+        }
+    }
+}
+
+_MERRY_INTERNAL_ msize_t merry_os_core_cpus(msize_t core_id, msize_t *cpus, msize_t *node)
+{
+    // the CPUs that the core is pinned to and its node; 0 CPUs if it isn't placed at all
+    MerryPlacement *place = &os.placement;
+    if (place->cpu_count > 0)
+    {
+        cpus[0] = place->cpus[core_id % place->cpu_count];
+        *node = place->topo.node_of[cpus[0]];
+        return 1;
+    }
+    if (place->numa == mfalse)
+        return 0;
+    *node = core_id % place->topo.node_count;
+    return merry_topology_node_cpus(&place->topo, *node, cpus, _MERRY_MAX_CPUS_);
+}
+
+_MERRY_INTERNAL_ mret_t merry_os_start_scheduler()
+{
+    if ((os.sched = merry_sched_init(os.worker_count, os.max_cores, &merry_os_core_done)) == RET_NULL)
+        return RET_FAILURE;
+    // the workers are placed just like the cores would be
+    msize_t cpus[_MERRY_MAX_CPUS_], node;
+    for (msize_t i = 0; i < os.worker_count; i++)
+    {
+        msize_t count = merry_os_core_cpus(i, cpus, &node);
+        if (count > 0 && merry_topology_pin(os.sched->workers[i].thread, cpus, count) == RET_FAILURE)
+            fprintf(stderr, "Warning: Failed to pin worker %lu.\n", i);
+    }
+    return RET_SUCCESS;
+}
+
 mret_t merry_os_init(mcstr_t _inp_file)
 {
     // initialize the os
@@ -23,6 +142,11 @@ mret_t merry_os_init(mcstr_t _inp_file)
         merry_destory_reader(input);
         return RET_FAILURE;
     }
+    if (os.placement.requested == mtrue)
+    {
+        merry_os_place_memory();
+        merry_os_report_placement();
+    }
     // perform initialization for the inst mem as well. Unlike data memory, instruction page len cannot be 0
     // based on the size of the input file, the reader should be able to independently run in the background as it reads the input file
     // the reader doesn't concern itself with the OS and so it can run independently
@@ -36,23 +160,42 @@ mret_t merry_os_init(mcstr_t _inp_file)
     }
     // time for locks and mutexes
     // _log_(_OS_, "Initialization", "Intializing necessary fields");
+    if (os.max_cores == 0)
+        os.max_cores = _MERRY_MAX_CORES_;
+    msize_t queue_len = _MERRY_REQUEST_QUEUE_LEN_(os.max_cores);
     if ((os._cond = merry_cond_init()) == RET_NULL)
         goto inp_failure;
     if ((os._lock = merry_mutex_init()) == RET_NULL)
         goto inp_failure;
     // don't forget to destory the reader
-    if (merry_requestHdlr_init(_MERRY_REQUEST_QUEUE_LEN_, os._cond) == RET_FAILURE)
+    if (merry_requestHdlr_init(queue_len, os._cond) == RET_FAILURE)
+        goto inp_failure;
+    // every core could be waiting on the same pool thread and so that is how long the queues need to be
+    if ((os.thPool = merry_init_thread_pool(_MERRY_THPOOL_LEN_, queue_len, &merry_os_service_request)) == RET_NULL)
+        goto inp_failure;
+    if ((os.callPool = merry_call_pool_init(&merry_os_call_copied, &merry_os_call_release, &merry_os_finish_request)) == RET_NULL)
+        goto inp_failure;
+    if (os.worker_count > 0 && merry_os_start_scheduler() == RET_FAILURE)
         goto inp_failure;
+    if (merry_file_table_init() == RET_FAILURE)
+        goto inp_failure;
+    if (merry_in_init() == RET_FAILURE)
+        goto inp_failure;
+    // every request could be a read or a write; without io_uring the pool does them
+    os.fserv = merry_file_service_init(queue_len < _MERRY_FSERV_MAX_OPS_ ? queue_len : _MERRY_FSERV_MAX_OPS_, &merry_os_finish_request);
     merry_destory_reader(input);
-    os.core_count = 1; // we will start with one core
-    os.cores = (MerryCore **)malloc(sizeof(MerryCore *));
+    atomic_init(&os.core_count, 1); // we will start with one core
+    atomic_init(&os.active_cores, 1);
+    atomic_init(&os.free_cores, RET_NULL);
+    // the table is never reallocated and so adding a core can't move it under anyone's feet
+    os.cores = (MerryCore **)calloc(os.max_cores, sizeof(MerryCore *));
     if (os.cores == RET_NULL)
         goto failure;
     os.cores[0] = merry_core_init(os.inst_mem, os.data_mem, 0);
     if (os.cores[0] == RET_NULL)
         goto failure;
     os.stop = mfalse;
-    os.core_threads = (MerryThread **)malloc(sizeof(MerryThread *)); // just 1 for now
+    os.core_threads = (MerryThread **)calloc(os.max_cores, sizeof(MerryThread *));
     if (os.core_threads == RET_NULL)
         goto failure;
     if (merry_loader_init(2) == mfalse)
@@ -69,15 +212,76 @@ inp_failure:
     return RET_FAILURE;
 }
 
+_MERRY_INTERNAL_ void merry_os_retire_cores()
+{
+    // the threads of the cores that are done are waiting for them to be given out again and the rest were stopped by merry_os_close_cores
+    // Every one of them must be gone before anything they use is freed
+    msize_t count = atomic_load(&os.core_count);
+    for (msize_t i = 0; i < count; i++)
+    {
+        MerryCore *core = os.cores[i];
+        if (core == RET_NULL)
+            continue;
+        merry_mutex_lock(core->lock);
+        core->retired = mtrue;
+        merry_cond_broadcast(core->cond);
+        merry_mutex_unlock(core->lock);
+    }
+    if (os.core_threads == RET_NULL)
+        return;
+    for (msize_t i = 0; i < count; i++)
+    {
+        MerryCore *core = os.cores[i];
+        if (core == RET_NULL || os.core_threads[i] == RET_NULL || atomic_load(&core->host) == _MERRY_CORE_ABANDONED_)
+            continue; // the abandoned ones may never come back
+        merry_mutex_lock(core->lock);
+        while (atomic_load(&core->run_state) != _MERRY_CORE_RETIRED_)
+            merry_cond_wait(core->cond, core->lock);
+        merry_mutex_unlock(core->lock);
+    }
+}
+
+_MERRY_INTERNAL_ mbool_t merry_os_close_cores()
+{
+    // returns mfalse if a core is blocked in the host and so the memory, the console and the cores must outlive us
+    mbool_t all = mtrue;
+    msize_t count = atomic_load(&os.core_count);
+    for (msize_t i = 0; i < count; i++)
+    {
+        MerryCore *core = os.cores[i];
+        if (core == RET_NULL || merry_core_close(core) == mtrue)
+            continue;
+        all = mfalse;
+        if (os.sched != RET_NULL)
+            merry_sched_abandon(os.sched, core->worker);
+    }
+    return all;
+}
+
 void merry_os_destroy()
 {
     // free all the cores, memory, os and then exit
     // _log_(_OS_, "Destroying", "Destroying the manager");
-    merry_dmemory_free(os.data_mem);
-    merry_memory_free(os.inst_mem);
+    // the workers and the pool go first as their threads may still be using the memory
+    // the scheduler itself has to stay until the pools are gone as they may still wake up cores
+    mbool_t closed = (os.cores != NULL) ? merry_os_close_cores() : mtrue;
+    merry_sched_stop(os.sched);
+    if (surelyT(os.cores != NULL))
+        merry_os_retire_cores();
+    merry_destroy_thread_pool(os.thPool);
+    merry_call_pool_destroy(os.callPool);
+    merry_file_service_destroy(os.fserv);
+    merry_sched_destroy(os.sched);
+    merry_file_table_destroy();
     merry_mutex_destroy(os._lock);
     merry_cond_destroy(os._cond);
-    if (surelyT(os.cores != NULL))
+    if (surelyT(closed == mtrue))
+    {
+        merry_in_destroy();
+        merry_dmemory_free(os.data_mem);
+        merry_memory_free(os.inst_mem);
+    }
+    if (surelyT(os.cores != NULL && closed == mtrue))
     {
         for (msize_t i = 0; i < os.core_count; i++)
         {
@@ -93,7 +297,6 @@ void merry_os_destroy()
         }
         free(os.core_threads);
     }
-    // merry_destroy_thread_pool(os.thPool);
     merry_loader_close();
     merry_requestHdlr_destroy();
 }
@@ -101,52 +304,95 @@ void merry_os_destroy()
 mret_t merry_os_boot_core(msize_t core_id, maddress_t start_addr)
 {
     // this function's job is to boot up the core_id core and prepare it for execution
-    os.cores[core_id]->pc = start_addr; // point to the starting address of the core
+    MerryCore *core = os.cores[core_id];
+    if (os.sched != RET_NULL)
+    {
+        // no thread for this one; it just goes on a run queue
+        merry_core_reset(core, start_addr);
+        merry_sched_add(os.sched, core);
+        return RET_SUCCESS;
+    }
+    if (os.core_threads[core_id] != RET_NULL)
+    {
+        // the core was given out before and its thread is still there waiting for it
+        merry_mutex_lock(core->lock);
+        merry_core_reset(core, start_addr);
+        atomic_store(&core->run_state, _MERRY_CORE_RUNNING_);
+        merry_cond_signal(core->cond);
+        merry_mutex_unlock(core->lock);
+        return RET_SUCCESS;
+    }
+    merry_core_reset(core, start_addr); // point to the starting address of the core
+    atomic_store(&core->run_state, _MERRY_CORE_RUNNING_);
     // now start the core thread
     // _llog_(_OS_, "Booting", "Booting core %d", core_id);
     if ((os.core_threads[core_id] = merry_thread_init()) == RET_NULL)
-        return RET_FAILURE;
-    if (merry_create_detached_thread(os.core_threads[core_id], &merry_runCore, os.cores[core_id]) == RET_FAILURE)
-        return RET_FAILURE;
+        goto failure;
+    msize_t cpus[_MERRY_MAX_CPUS_], node;
+    msize_t count = merry_os_core_cpus(core_id, cpus, &node);
+    // the stack is still untouched and so it goes to the node as soon as the core uses it
+    if (count > 0 && os.placement.numa == mtrue)
+        merry_topology_bind(&os.placement.topo, os.cores[core_id]->stack_mem, _MERRY_STACKMEM_BYTE_LEN_, node);
+    // pinned before it starts so that its first touches of the stack already happen on its node
+    if (count > 0 && merry_topology_start_pinned(os.core_threads[core_id], &merry_runCore, core, cpus, count) == RET_SUCCESS)
+        return RET_SUCCESS;
+    if (count > 0)
+        fprintf(stderr, "Warning: Failed to pin core %lu.\n", core_id);
+    if (merry_create_detached_thread(os.core_threads[core_id], &merry_runCore, core) == RET_FAILURE)
+    {
+        merry_thread_destroy(os.core_threads[core_id]);
+        os.core_threads[core_id] = RET_NULL;
+        goto failure;
+    }
     // _llog_(_OS_, "Booting", "Booting core %d succeeded", core_id);
     return RET_SUCCESS;
+failure:
+    // the core never ran and so it can be given out again
+    atomic_fetch_sub(&os.active_cores, 1);
+    atomic_store(&core->run_state, _MERRY_CORE_DONE_);
+    merry_os_core_done(core);
+    return RET_FAILURE;
 }
 
-mret_t merry_os_add_core()
+mret_t merry_os_add_core(msize_t *core_id)
 {
-    // just add another core
-    MerryThread **temp = (MerryThread **)malloc(sizeof(MerryThread *) * (os.core_count + 1));
-    if (temp == NULL)
-        return RET_FAILURE; // we failed
-    MerryCore **tempc = (MerryThread **)malloc(sizeof(MerryThread *) * (os.core_count + 1));
-    if (tempc == NULL)
-    {
-        // we failed again
-        free(temp);
-        return RET_FAILURE;
-    }
-    tempc[os.core_count] = merry_core_init(os.inst_mem, os.data_mem, os.core_count);
-    if (tempc[os.core_count] == RET_NULL)
+    // A core that is done is given out again along with its stack and its thread(if it has one) and so it costs next to nothing
+    // Only the Manager takes cores off the free list and so the head can't be taken and put back under our feet between the load and the exchange
+    MerryCore *core = atomic_load(&os.free_cores);
+    while (core != RET_NULL && atomic_compare_exchange_weak(&os.free_cores, &core, core->next_free) == mfalse)
+        ;
+    if (core == RET_NULL)
     {
-        free(temp);
-        free(tempc);
-        return RET_FAILURE;
+        // claim a new slot in the table
+        msize_t id = atomic_load(&os.core_count);
+        do
+        {
+            if (id == os.max_cores)
+                return RET_FAILURE; // the request queue only has room for this many cores
+        } while (atomic_compare_exchange_weak(&os.core_count, &id, id + 1) == mfalse);
+        if ((core = merry_core_init(os.inst_mem, os.data_mem, id)) == RET_NULL)
+            return RET_FAILURE; // the slot stays empty
+        os.cores[id] = core;
     }
-    // we have succeeded in add cores
-    merry_mutex_lock(os._lock); // Safety for when request Pool is implemented
-    for (msize_t i = 0; i <= os.core_count; i++)
+    atomic_fetch_add(&os.active_cores, 1);
+    *core_id = core->core_id;
+    return RET_SUCCESS;
+}
+
+mbool_t merry_os_core_done(MerryCore *core)
+{
+    // a request that is still in flight would write into the core after it was given out again and so such a core is left alone for good
+    for (msize_t i = 0; i < _MERRY_ASYNC_SLOTS_; i++)
     {
-        temp[i] = os.core_threads[i];
-        tempc[i] = os.cores[i];
+        if (core->async[i].in_use == mtrue && atomic_load(&core->async[i].completion.done) == mfalse)
+            return mfalse;
     }
-    // now free the old pointers and replace them
-    free(os.core_threads);
-    free(os.cores);
-    os.core_threads = temp;
-    os.cores = tempc;
-    os.core_count++;
-    merry_mutex_unlock(os._lock);
-    return RET_SUCCESS;
+    MerryCore *head = atomic_load(&os.free_cores);
+    do
+    {
+        core->next_free = head;
+    } while (atomic_compare_exchange_weak(&os.free_cores, &head, core) == mfalse);
+    return mtrue;
 }
 
 _MERRY_INTERNAL_ void merry_os_prepare_for_exit()
@@ -156,13 +402,206 @@ _MERRY_INTERNAL_ void merry_os_prepare_for_exit()
     // _log_(_OS_, "Exiting", "Preparing for exit");
     for (msize_t i = 0; i < os.core_count; i++)
     {
-        atomic_exchange(&os.cores[i]->stop_running, mtrue);
+        if (os.cores[i] != RET_NULL)
+            atomic_exchange(&os.cores[i]->stop_running, mtrue);
     }
     // some cores may be waiting for their requests to be fulfilled
     merry_requestHdlr_kill_requests(); // kill all requests
     os.stop = mtrue;                   // done
 }
 
+_MERRY_INTERNAL_ void merry_os_service_request(MerryOSRequest *request)
+{
+    // This fulfills the requests that don't change the state of the VM itself
+    // It runs on the threads of the pool and so every one of these must be safe to run alongside each other as long as they have different keys
+    // The file service may still have a read or write on the file that came before this one
+    if (request->file != RET_NULL)
+        merry_file_wait_queue(request->file);
+    switch (request->request_number)
+    {
+    case _REQ_READCHAR:
+        if (merry_read_char(os.data_mem, request->regs[Ma]) == RET_FAILURE)
+            request->regs[Ma] = 1; // error
+        else
+            request->regs[Ma] = 0; // success
+        break;
+    case _REQ_WRITECHAR:
+        if (merry_write_char(os.data_mem, request->regs[Ma]) == RET_FAILURE)
+            request->regs[Ma] = 1; // error
+        else
+            request->regs[Ma] = 0; // success
+        break;
+    case _REQ_DYNL:
+        merry_os_execute_request_dynl(&os, request);
+        break;
+    case _REQ_DYNUL:
+        merry_os_execute_request_dynul(&os, request);
+        break;
+    case _REQ_DYNCALL:
+        if (merry_os_execute_request_dyncall(&os, request) == RET_AMBIGIOUS)
+            return; // the call pool wakes up the core
+        break;
+    case _REQ_DYNBIND:
+        merry_os_execute_request_dynbind(&os, request);
+        break;
+    case _REQ_NCALL:
+        if (merry_os_execute_request_ncall(&os, request) == RET_AMBIGIOUS)
+            return;
+        break;
+    case _REQ_DYNSIG:
+        merry_os_execute_request_dynsig(&os, request);
+        break;
+    case _REQ_DYNTIMEOUT:
+        merry_os_execute_request_dyntimeout(&os, request);
+        break;
+    case _REQ_FOPEN:
+        merry_os_execute_request_fopen(&os, request);
+        break;
+    case _REQ_FCLOSE:
+        merry_os_execute_request_fclose(&os, request);
+        break;
+    case _REQ_FREAD:
+        merry_os_execute_request_fread(&os, request);
+        break;
+    case _REQ_FWRITE:
+        merry_os_execute_request_fwrite(&os, request);
+        break;
+    case _REQ_FEOF:
+        merry_os_execute_request_feof(&os, request);
+        break;
+    case _REQ_FPREAD:
+        merry_os_execute_request_fpread(&os, request);
+        break;
+    case _REQ_FPWRITE:
+        merry_os_execute_request_fpwrite(&os, request);
+        break;
+    case _REQ_FSEEK:
+        merry_os_execute_request_fseek(&os, request);
+        break;
+    case _REQ_FTELL:
+        merry_os_execute_request_ftell(&os, request);
+        break;
+    case _REQ_FSIZE:
+        merry_os_execute_request_fsize(&os, request);
+        break;
+    case _REQ_FREADV:
+        merry_os_execute_request_freadv(&os, request);
+        break;
+    case _REQ_FWRITEV:
+        merry_os_execute_request_fwritev(&os, request);
+        break;
+    case _REQ_FMAP:
+        merry_os_execute_request_fmap(&os, request);
+        break;
+    case _REQ_FUNMAP:
+        merry_os_execute_request_funmap(&os, request);
+        break;
+    case _REQ_FCOPY:
+        merry_os_execute_request_fcopy(&os, request);
+        break;
+    default:
+        /// NOTE: this will come in handy when we implement some built-in syscalls and the program provides invalid syscalls
+        fprintf(stderr, "Error: Unknown request code: '%lu' is not a valid request code", request->request_number);
+        break;
+    }
+    // a closed handle's descriptor is closed right here if this was the last thing using it
+    if (request->file != RET_NULL)
+        merry_file_drop(request->file);
+    merry_os_finish_request(request);
+}
+
+_MERRY_INTERNAL_ void merry_os_finish_request(MerryOSRequest *request)
+{
+    if (request->result != RET_NULL)
+    {
+        // asynchronous requests leave their results in the descriptor and the status goes last so that the program never sees half the results
+        request->result[_MERRY_ASYNC_DESC_MA_] = request->regs[Ma];
+        request->result[_MERRY_ASYNC_DESC_MB_] = request->regs[Mb];
+        atomic_store_explicit((_Atomic mqword_t *)&request->result[_MERRY_ASYNC_DESC_STATUS_], 1, memory_order_release);
+    }
+    // after the fulfillment of the request, wake up the core
+    // _llog_(_OS_, "REQ_FULFILLED", "Core ID %lu request %lu fulfilled, Waking up", request->id, request->request_number);
+    merry_requestHdlr_complete(request);
+}
+
+_MERRY_INTERNAL_ mret_t merry_os_prep_file_request(MerryOSRequest *request)
+{
+    // give the read or write to io_uring
+    // anything wrong with the request or anything too big for it is left for the pool to find and panic about or fulfill
+    MerryIOVec iov[_MERRY_FSERV_IOV_MAX_];
+    msize_t count;
+    if (os.fserv == RET_NULL)
+        return RET_FAILURE;
+    switch (request->request_number)
+    {
+    case _REQ_FREAD:
+    case _REQ_FWRITE:
+    case _REQ_FPREAD:
+    case _REQ_FPWRITE:
+        break;
+    default:
+        return RET_FAILURE; // not a read or write
+    }
+    MerryFile *file = request->file;
+    mbool_t is_read = request->request_number == _REQ_FREAD || request->request_number == _REQ_FPREAD;
+    if (merry_dmemory_get_span(os.data_mem, request->regs[Ma], request->regs[Mc], is_read, iov, _MERRY_FSERV_IOV_MAX_, &count) == RET_FAILURE)
+        return RET_FAILURE;
+    mqword_t offset = (request->request_number == _REQ_FPREAD || request->request_number == _REQ_FPWRITE) ? request->regs[Md] : _MERRY_FILE_CUR_POS_;
+    return merry_file_service_prep(os.fserv, request, file, iov, count, offset);
+}
+
+_MERRY_INTERNAL_ mbool_t merry_os_is_file_request(msize_t request_number)
+{
+    // the requests on the file handle in Mb
+    switch (request_number)
+    {
+    case _REQ_FCLOSE:
+    case _REQ_FREAD:
+    case _REQ_FWRITE:
+    case _REQ_FEOF:
+    case _REQ_FPREAD:
+    case _REQ_FPWRITE:
+    case _REQ_FSEEK:
+    case _REQ_FTELL:
+    case _REQ_FSIZE:
+    case _REQ_FREADV:
+    case _REQ_FWRITEV:
+    case _REQ_FCOPY: // the destination
+        return mtrue;
+    }
+    return mfalse;
+}
+
+_MERRY_INTERNAL_ msize_t merry_os_request_key(MerryOSRequest *request)
+{
+    // Requests that must stay in order share a key
+    // Everything on a file handle is ordered, the console input and output are ordered and the dynamic loader isn't thread safe so that is one key too
+    register mqword_t handle = request->regs[Mb];
+    switch (request->request_number)
+    {
+    case _REQ_READCHAR:
+        return _MERRY_KEY_CONSOLE_IN_;
+    case _REQ_WRITECHAR:
+        return _MERRY_KEY_CONSOLE_OUT_;
+    case _REQ_DYNL:
+    case _REQ_DYNUL:
+    case _REQ_DYNCALL:
+    case _REQ_DYNBIND:
+    case _REQ_NCALL:
+    case _REQ_DYNSIG:
+    case _REQ_DYNTIMEOUT:
+        return _MERRY_KEY_DYNL_;
+    case _REQ_FMAP:
+    case _REQ_FUNMAP: // has no handle but mustn't run alongside a mapping of the same pages
+        return _MERRY_KEY_MEMMAP_;
+    }
+    // FCOPY is ordered with the destination; the source's order is up to the program
+    if (merry_os_is_file_request(request->request_number) == mtrue)
+        return _MERRY_KEY_FIRST_FREE_ + handle;
+    // opening a file doesn't depend on anything else
+    return _MERRY_KEY_FIRST_FREE_ + request->id;
+}
+
 /*From here the OS gets requests from the request handler and fulfills the request*/
 _THRET_T_ merry_os_start_vm(mptr_t some_arg)
 {
@@ -175,103 +614,76 @@ _THRET_T_ merry_os_start_vm(mptr_t some_arg)
     // Core 0 is now up and running
     // The OS should be ready to handle requests
     MerryOSRequest current_req;
-    mptr_t temp;
     // _log_(_OS_, "STARTING EXECUTION", "Manager is entering the request handling loop");
     while (os.stop == mfalse)
     {
-        // there is no need to lock the OS now so maybe we won't need the Mutex locks
-        // We can implement the OS to be capable of handling various services at once
-        // for eg: It could provide input service for one core while providing output service for another core simultaneoulsy
-        // This would utilize the OS's full potential and the time wasted by core's waiting would be eliminated
+        // This thread is only the coordinator now
+        // It handles errors and the requests that change the VM's state itself while the services are handed over to the thread pool
+        // That way, it could provide input service for one core while providing output service for another core simultaneoulsy
         if (merry_requestHdlr_pop_request(&current_req) == mfalse)
         {
             // we have no requests to fulfill and so we goto sleep and wait for the request handler to wake us up
+            // but the reads and writes prepared so far are submitted first
             // _log_(_OS_, "Waiting", "Manager waiting for requests");
-            merry_cond_wait(os._cond, os._lock);
+            if (os.fserv != RET_NULL)
+                merry_file_service_flush(os.fserv);
+            merry_requestHdlr_wait();
+            continue;
+        }
+        // we have a request to fulfill
+        if (_MERRY_REQUEST_INTERNAL_ERROR_(current_req.request_number))
+        {
+            // _llog_(_OS_, "Error", "Internal Error Detected: Error code %d", current_req.request_number);
+            merry_os_handle_internal_module_error(current_req.request_number);
+            merry_os_prepare_for_exit(); // now since this is an error, we can't continue
+        }
+        else if (_MERRY_REQUEST_PROGRAM_ERROR_(current_req.request_number))
+        {
+            // _llog_(_OS_, "Error", "Program generated error: Error code %d", current_req.request_number);
+            merry_os_handle_error(current_req.request_number); // this will handle all errors
+            merry_os_prepare_for_exit();
         }
         else
         {
-            // we have a request to fulfill
-            if (_MERRY_REQUEST_INTERNAL_ERROR_(current_req.request_number))
-            {
-                // _llog_(_OS_, "Error", "Internal Error Detected: Error code %d", current_req.request_number);
-                merry_os_handle_internal_module_error(current_req.request_number);
-                merry_os_prepare_for_exit(); // now since this is an error, we can't continue
-            }
-            else if (_MERRY_REQUEST_PROGRAM_ERROR_(current_req.request_number))
+            switch (current_req.request_number)
             {
-                // _llog_(_OS_, "Error", "Program generated error: Error code %d", current_req.request_number);
-                merry_os_handle_error(current_req.request_number); // this will handle all errors
+            case _REQ_REQHALT: // halting request
+                // _llog_(_OS_, "REQ", "Halt request received from core ID %lu", current_req.id);
+                merry_os_execute_request_halt(&os, &current_req); // this shouldn't generate any errors
+                break;
+            case _REQ_EXIT:
+                // _llog_(_OS_, "REQ", "Exit request received from core ID %lu", current_req.id);
                 merry_os_prepare_for_exit();
-            }
-            else
+                os.ret = current_req.regs[Ma];
+                break;
+            case _REQ_NEWCORE:
+                // _llog_(_OS_, "REQ", "New core creation request received from core ID %lu", current_req.id);
+                merry_os_execute_request_new_core(&os, &current_req);
+                break;
+            default:
             {
-                switch (_MERRY_REQUEST_VALID_(current_req.request_number))
-                {
-                default:
-                    // it is most likely an actual request
-                    switch (current_req.request_number)
-                    {
-                    case _REQ_REQHALT: // halting request
-                        // _llog_(_OS_, "REQ", "Halt request received from core ID %lu", current_req.id);
-                        merry_os_execute_request_halt(&os, &current_req); // this shouldn't generate any errors
-                        break;
-                    case _REQ_EXIT:
-                        // _llog_(_OS_, "REQ", "Exit request received from core ID %lu", current_req.id);
-                        merry_os_prepare_for_exit();
-                        os.ret = os.cores[current_req.id]->registers[Ma];
-                        break;
-                    case _REQ_NEWCORE:
-                        // _llog_(_OS_, "REQ", "New core creation request received from core ID %lu", current_req.id);
-                        merry_os_execute_request_new_core(&os, &current_req);
-                        break;
-                    case _REQ_READCHAR:
-                        if (merry_read_char(os.data_mem, os.cores[current_req.id]->registers[Ma]) == RET_FAILURE)
-                            os.cores[current_req.id]->registers[Ma] = 1; // error
-                        else
-                            os.cores[current_req.id]->registers[Ma] = 0; // success
-                        break;
-                    case _REQ_WRITECHAR:
-                        if (merry_write_char(os.data_mem, os.cores[current_req.id]->registers[Ma]) == RET_FAILURE)
-                            os.cores[current_req.id]->registers[Ma] = 1; // error
-                        else
-                            os.cores[current_req.id]->registers[Ma] = 0; // success
-                        break;
-                    case _REQ_DYNL:
-                        merry_os_execute_request_dynl(&os, &current_req);
-                        break;
-                    case _REQ_DYNUL:
-                        merry_os_execute_request_dynul(&os, &current_req);
-                        break;
-                    case _REQ_DYNCALL:
-                        merry_os_execute_request_dyncall(&os, &current_req);
-                        break;
-                    case _REQ_FOPEN:
-                        merry_os_execute_request_fopen(&os, &current_req);
-                        break;
-                    case _REQ_FCLOSE:
-                        merry_os_execute_request_fclose(&os, &current_req);
-                        break;
-                    case _REQ_FREAD:
-                        merry_os_execute_request_fread(&os, &current_req);
-                        break;
-                    case _REQ_FWRITE:
-                        merry_os_execute_request_fwrite(&os, &current_req);
-                        break;
-                    case _REQ_FEOF:
-                        merry_os_execute_request_feof(&os, &current_req);
-                        break;
-                    default:
-                        /// NOTE: this will come in handy when we implement some built-in syscalls and the program provides invalid syscalls
-                        fprintf(stderr, "Error: Unknown request code: '%llu' is not a valid request code", current_req.request_number);
-                        break;
-                    }
-                }
+                // it is most likely a service
+                // a request on a file holds it until it is fulfilled so that closing the handle can't take the descriptor from under it
+                msize_t refs = 0;
+                current_req.file = RET_NULL;
+                if (merry_os_is_file_request(current_req.request_number) == mtrue)
+                    current_req.file = merry_file_hold(current_req.regs[Mb], &refs);
+                // everything on a handle is done in order and so the file service only gets a read or write when nothing else holds the file
+                if (refs == 1 && merry_os_prep_file_request(&current_req) == RET_SUCCESS)
+                    continue; // a read or write that the file service took and so it wakes up the core
+                // the pool waits for whatever the file service has on the file and so it can't be left unsubmitted
+                if (current_req.file != RET_NULL && atomic_load(&current_req.file->queued) > 0)
+                    merry_file_service_flush(os.fserv);
+                // if the pool can't take it, we do it ourselves
+                if (merry_thPool_assign(os.thPool, merry_os_request_key(&current_req), &current_req) == RET_FAILURE)
+                    merry_os_service_request(&current_req);
+                continue; // the core is woken up by whoever fulfills it
+            }
             }
-            // after the fulfillment of the request, wake up the core
-            // _llog_(_OS_, "REQ_FULFILLED", "Core ID %lu request %lu fulfilled, Waking up", current_req.id, current_req.request_number);
-            merry_cond_signal(current_req._wait_lock);
         }
+        // after the fulfillment of the request, wake up the core
+        // _llog_(_OS_, "REQ_FULFILLED", "Core ID %lu request %lu fulfilled, Waking up", current_req.id, current_req.request_number);
+        merry_requestHdlr_complete(&current_req);
     }
 // _llog_(_OS_, "EXIT", "Manager terminating with exit code %ld", os.ret);
 #if defined(_MERRY_HOST_OS_LINUX_)
@@ -295,6 +707,9 @@ void merry_os_handle_error(merrot_t error)
         // this implies that the access is being requested for address that doesn't really exist
         merry_mem_error("Request to access memory that doesn't exist. Invalid address");
         break;
+    case MERRY_MEM_READ_ONLY:
+        merry_mem_error("Storing to memory that a file is mapped to read-only");
+        break;
     case MERRY_DIV_BY_ZERO:
         merry_general_error("Div by zero", "Attempting to divide by zero");
         break;
@@ -322,6 +737,33 @@ void merry_os_handle_error(merrot_t error)
     case MERRY_FILEHANDLE_NULL:
         merry_general_error("Failed to perform file operations", "The file handle is NULL and trying to perform operations on a NULL handle is not a good idea.");
         break;
+    case MERRY_INVALID_FILEHANDLE:
+        merry_general_error("Failed to perform file operations", "The file handle doesn't belong to any open file");
+        break;
+    case MERRY_INVALID_IOV:
+        merry_general_error("Failed to perform file operations", "The read or write needs too many host buffers(more than 1024 buffers or pages)");
+        break;
+    case MERRY_INVALID_ASYNC_REQUEST:
+        merry_general_error("Invalid asynchronous request", "HALT, EXIT and NEW_CORE cannot be requested asynchronously");
+        break;
+    case MERRY_ASYNC_SLOTS_FULL:
+        merry_general_error("Too many asynchronous requests", "Collect the tickets with APOLL or AWAIT before making more requests");
+        break;
+    case MERRY_INVALID_TICKET:
+        merry_general_error("Invalid ticket", "The ticket doesn't belong to any asynchronous request in flight");
+        break;
+    case MERRY_DYNBIND_FAILED:
+        merry_general_error("Dynamic Bind Failed", "The function couldn't be found or every slot is already bound");
+        break;
+    case MERRY_INVALID_DYNSLOT:
+        merry_general_error("Dynamic Call Failed", "No function is bound to the slot; Maybe its library was unloaded?");
+        break;
+    case MERRY_DYNSIG_FAILED:
+        merry_general_error("Invalid signature", "The signature is malformed, has more than 6 integer or 8 floating point arguments or the host can't make typed calls");
+        break;
+    case MERRY_INVALID_INTRINSIC:
+        merry_general_error("Invalid intrinsic", "No intrinsic has the index given to icall");
+        break;
     default:
         merry_error("Unknown error code: '%llu' is not a valid error code", error);
         break;
@@ -7,14 +7,13 @@ _os_exec_(halt)
     // since the core's decoder won't mess with other fields of the core, we can freely make changes
     // _llog_(_OS_, "Request", " Fulfilling the halt request: Requester %d", request->id);
     os->cores[request->id]->stop_running = mtrue; // this will automatically halt the core's decoder as well
-    if (os->core_count == 1)                      // I am an idiot
+    if (atomic_fetch_sub(&os->active_cores, 1) == 1)
     {
-        // we had only one core to begin with then stop any further execution
+        // that was the last core running and so stop any further execution
         os->stop = mtrue;
         // the core that makes this request should have the return value in Ma register
-        os->ret = os->cores[request->id]->registers[Ma];
+        os->ret = request->regs[Ma];
     }
-    printf("Halting.\n"); /// TODO: remove this
     // _llog_(_OS_, "REQ_SUCCESS", "Halt request successfully fulfilled for core ID %lu", os->cores[request->id]->core_id);
     return RET_SUCCESS; // for mitigating compiler's warning
 }
@@ -23,15 +22,16 @@ _os_exec_(new_core)
 {
     // generate a new core
     // _llog_(_OS_, "Request", " Creating a new core: Requester %d", request->id);
-    if (merry_os_add_core() == RET_FAILURE)
+    msize_t core_id;
+    if (merry_os_add_core(&core_id) == RET_FAILURE)
     {
         // let the core know that its request was a failure
-        os->cores[request->id]->registers[Ma] = 1; // Ma should contain the address and it will be updated with the result of the request
+        request->regs[Ma] = 0; // Ma should contain the address and it will be updated with the result of the request
         // _llog_(_OS_, "Request", "Creation of a new core failed: Requester %d", request->id);
     }
     else
     {
-        os->cores[request->id]->registers[Ma] = merry_os_boot_core(os->core_count - 1, os->cores[request->id]->registers[Ma]);
+        request->regs[Ma] = merry_os_boot_core(core_id, request->regs[Ma]);
         // _llog_(_OS_, "Request", " Successfully Created a new core: Requester %d", request->id);
     }
     return RET_SUCCESS; // for now
@@ -41,13 +41,13 @@ _os_exec_(dynl)
 {
     // the address to the name of the library must be in the Ma register
     // if the name is not and it is invalidly placed, the host will throw a segfault
-    mbptr_t name = merry_dmemory_get_byte_address(os->data_mem, os->cores[request->id]->registers[Ma]);
+    mbptr_t name = merry_dmemory_get_byte_address(os->data_mem, request->regs[Ma]);
     if (name == RET_NULL)
     {
         merry_requestHdlr_panic(os->data_mem->error);
         return RET_FAILURE;
     }
-    if (merry_loader_loadLib(name, &os->cores[request->id]->registers[Mb]) == mfalse)
+    if (merry_loader_loadLib((mstr_t)name, &request->regs[Mb]) == mfalse)
     {
         merry_requestHdlr_panic(MERRY_DYNL_FAILED);
         return RET_FAILURE;
@@ -57,31 +57,269 @@ _os_exec_(dynl)
 
 _MERRY_ALWAYS_INLINE_ _os_exec_(dynul)
 {
-    merry_loader_unloadLib(os->cores[request->id]->registers[Mb]);
+    merry_loader_unloadLib(request->regs[Mb]);
+    return RET_SUCCESS;
+}
+
+// A call with a timeout may outlive the request and even the VM and so the function gets copies of the memory that its pointers point to
+// Each copy is as long as the signature(or Md for a function without one) says and it is stored back only if the function returned in time
+typedef struct MerryOSCallCopy MerryOSCallCopy;
+typedef struct MerryOSCallArgs MerryOSCallArgs;
+
+struct MerryOSCallCopy
+{
+    maddress_t address; // where it was copied from
+    msize_t len;
+    mbptr_t copy;
+};
+
+struct MerryOSCallArgs
+{
+    MerryDMemory *mem;
+    msize_t slot; // held until the copies are released so that the library isn't closed under the function
+    mqword_t args[_MERRY_DYN_MAX_ARGS_];
+    MerryOSCallCopy copies[_MERRY_DYN_MAX_ARGS_];
+    msize_t copy_count;
+};
+
+_MERRY_INTERNAL_ mret_t merry_os_copy_out(MerryOSCallArgs *args, maddress_t address, msize_t len, mqptr_t into)
+{
+    // the function may store into all of it
+    mbptr_t host;
+    if (len == 0 || (host = merry_dmemory_get_byte_address_store(args->mem, address, len - 1)) == RET_NULL)
+        return RET_FAILURE;
+    MerryOSCallCopy *copy = &args->copies[args->copy_count];
+    copy->address = address;
+    copy->len = len;
+    if ((copy->copy = (mbptr_t)malloc(len)) == RET_NULL)
+        return RET_FAILURE;
+    memcpy(copy->copy, host, len);
+    args->copy_count++;
+    *into = (mqword_t)copy->copy;
+    return RET_SUCCESS;
+}
+
+_MERRY_INTERNAL_ MerryOSCallArgs *merry_os_copy_args(MerryDMemory *mem, MerryDynSig *sig, mqptr_t regs)
+{
+    // the arguments exactly as merry_os_call_function would pass them but with the pointers into the copies
+    MerryOSCallArgs *args = (MerryOSCallArgs *)calloc(1, sizeof(MerryOSCallArgs));
+    if (args == RET_NULL)
+    {
+        merry_requestHdlr_panic(MERRY_DYNCALL_FAILED);
+        return RET_NULL;
+    }
+    args->mem = mem;
+    args->slot = _MERRY_DYN_SLOTS_; // not held yet
+    merrot_t error = MERRY_DYNCALL_FAILED;
+    if (sig->typed == mfalse)
+    {
+        // the parameter is the qword that Mc is in and Md is how many bytes from there the function uses(0 for just the qword)
+        if (merry_os_copy_out(args, regs[Mc] & ~(maddress_t)7, regs[Md] == 0 ? 8 : regs[Md], &args->args[0]) == RET_FAILURE)
+            goto failure;
+        return args;
+    }
+    mqptr_t from = &regs[Mc];
+    if (sig->from_block == mtrue && (from = merry_dmemory_get_qword_address_bounds(mem, regs[Mc], sig->argc)) == RET_NULL)
+    {
+        error = mem->error;
+        goto failure;
+    }
+    for (msize_t i = 0; i < sig->argc; i++)
+    {
+        args->args[i] = from[i];
+        if (sig->args[i] != 'p')
+            continue;
+        // there is no knowing how much to copy for a p without its length
+        if (sig->lens[i] == 0)
+            goto failure;
+        if (merry_os_copy_out(args, from[i], sig->lens[i], &args->args[i]) == RET_FAILURE)
+        {
+            error = mem->error;
+            goto failure;
+        }
+    }
+    return args;
+failure:
+    merry_requestHdlr_panic(error);
+    merry_os_call_release(args, mfalse);
+    return RET_NULL;
+}
+
+void merry_os_call_copied(dynfunc_t function, MerryDynSig *sig, mptr_t arg, mqptr_t regs)
+{
+    MerryOSCallArgs *args = (MerryOSCallArgs *)arg;
+    if (sig->typed == mfalse)
+        regs[Ma] = function((mqptr_t)args->args[0]);
+    else
+        regs[Ma] = merry_loader_call_typed(function, sig, args->args);
+}
+
+void merry_os_call_release(mptr_t arg, mbool_t returned)
+{
+    MerryOSCallArgs *args = (MerryOSCallArgs *)arg;
+    for (msize_t i = 0; i < args->copy_count; i++)
+    {
+        MerryOSCallCopy *copy = &args->copies[i];
+        // the memory may have been mapped read-only meanwhile in which case the changes are lost
+        mbptr_t host;
+        if (returned == mtrue && (host = merry_dmemory_get_byte_address_store(args->mem, copy->address, copy->len - 1)) != RET_NULL)
+            memcpy(host, copy->copy, copy->len);
+        free(copy->copy);
+    }
+    if (args->slot != _MERRY_DYN_SLOTS_)
+        merry_loader_leave(args->slot);
+    free(args);
+}
+
+_MERRY_INTERNAL_ mret_t merry_os_call_timed(Merry *os, MerryOSRequest *request, dynfunc_t function, msize_t slot, MerryDynSig *sig)
+{
+    // Mb tells the program how the call went
+    MerryOSCallArgs *args = merry_os_copy_args(os->data_mem, sig, request->regs);
+    if (args == RET_NULL)
+        return RET_FAILURE;
+    merry_loader_hold(slot);
+    args->slot = slot;
+    if (merry_call_pool_call(os->callPool, request, function, sig, args, merry_loader_get_timeout(slot)) == RET_SUCCESS)
+        return RET_AMBIGIOUS; // the request is the pool's now
+    merry_os_call_release(args, mfalse);
+    request->regs[Ma] = 0;
+    request->regs[Mb] = _MERRY_CALL_NO_WORKER_;
     return RET_SUCCESS;
 }
 
 _os_exec_(dyncall)
 {
+    // the function is called with the address of the parameter exactly like one without a signature
+    static MerryDynSig untyped = {.typed = mfalse};
     dynfunc_t function;
-    mqptr_t param = merry_dmemory_get_qword_address(os->data_mem, os->cores[request->id]->registers[Mc]);
-    mbptr_t func_name = merry_dmemory_get_byte_address(os->data_mem, os->cores[request->id]->registers[Ma]);
+    msize_t slot;
+    mqptr_t param = merry_dmemory_get_qword_address_store(os->data_mem, request->regs[Mc], 0);
+    mbptr_t func_name = merry_dmemory_get_byte_address(os->data_mem, request->regs[Ma]);
     if (param == NULL || func_name == NULL)
     {
         merry_requestHdlr_panic(MERRY_DYNCALL_FAILED);
         return RET_FAILURE;
     }
-    if ((function = merry_loader_getFuncSymbol(os->cores[request->id]->registers[Mb], func_name)) == RET_NULL)
+    // the name is looked up only the first time
+    if ((function = merry_loader_resolve(request->regs[Mb], (mstr_t)func_name, &slot)) == RET_NULL)
     {
         merry_requestHdlr_panic(MERRY_DYNCALL_FAILED);
         return RET_FAILURE;
     }
-    os->cores[request->id]->registers[Ma] = function(param);
+    if (merry_loader_get_timeout(slot) != 0)
+        return merry_os_call_timed(os, request, function, slot, &untyped);
+    request->regs[Ma] = function(param);
     return RET_SUCCESS;
 }
 
-/// NOTE: It is the program's job to not mess with the file handle. The VM might crash or undefined behaviour could occur. Since there is no direct way for the VM to know that the file handle
-// is indeed valid, it is the program's job to keep the handle safe. The same can be applied to the handle returned by dynl
+_os_exec_(dynbind)
+{
+    // the address of the function's name is in Ma, the library's handle in Mb and Mc is 1 if the function is thread safe
+    // the slot is returned in Ma
+    mbptr_t func_name = merry_dmemory_get_byte_address(os->data_mem, request->regs[Ma]);
+    if (func_name == NULL)
+    {
+        merry_requestHdlr_panic(os->data_mem->error);
+        return RET_FAILURE;
+    }
+    if (merry_loader_bind(request->regs[Mb], (mstr_t)func_name, request->regs[Mc] == 1, &request->regs[Ma]) == mfalse)
+    {
+        merry_requestHdlr_panic(MERRY_DYNBIND_FAILED);
+        return RET_FAILURE;
+    }
+    return RET_SUCCESS;
+}
+
+mret_t merry_os_call_slot(MerryDMemory *mem, dynfunc_t function, msize_t slot, mqptr_t regs)
+{
+    return merry_os_call_function(mem, function, merry_loader_get_sig(slot), regs);
+}
+
+mret_t merry_os_call_function(MerryDMemory *mem, dynfunc_t function, MerryDynSig *sig, mqptr_t regs)
+{
+    if (sig->typed == mfalse)
+    {
+        // the function takes the address of its parameter in Mc and may store into it
+        mqptr_t param = merry_dmemory_get_qword_address_store(mem, regs[Mc], 0);
+        if (param == NULL)
+        {
+            merry_requestHdlr_panic(MERRY_DYNCALL_FAILED);
+            return RET_FAILURE;
+        }
+        regs[Ma] = function(param);
+        return RET_SUCCESS;
+    }
+    // the arguments are in the registers from Mc onwards or in the block at the address in Mc
+    mqword_t args[_MERRY_DYN_MAX_ARGS_];
+    mqptr_t from = &regs[Mc];
+    if (sig->from_block == mtrue && (from = merry_dmemory_get_qword_address_bounds(mem, regs[Mc], sig->argc)) == RET_NULL)
+    {
+        merry_requestHdlr_panic(mem->error);
+        return RET_FAILURE;
+    }
+    for (msize_t i = 0; i < sig->argc; i++)
+    {
+        args[i] = from[i];
+        if (sig->args[i] != 'p')
+            continue;
+        // the function gets the host's address; it is good only until the end of the page and it may be stored to
+        // the bytes the signature gives it must all be in the page
+        mbptr_t host = merry_dmemory_get_byte_address_store(mem, args[i], sig->lens[i] == 0 ? 0 : sig->lens[i] - 1);
+        if (host == RET_NULL)
+        {
+            merry_requestHdlr_panic(mem->error);
+            return RET_FAILURE;
+        }
+        args[i] = (mqword_t)host;
+    }
+    regs[Ma] = merry_loader_call_typed(function, sig, args);
+    return RET_SUCCESS;
+}
+
+_os_exec_(ncall)
+{
+    // the same as dyncall but the function comes from the slot in Mb
+    dynfunc_t function = merry_loader_get_slot(request->regs[Mb]);
+    if (function == RET_NULL)
+    {
+        merry_requestHdlr_panic(MERRY_INVALID_DYNSLOT);
+        return RET_FAILURE;
+    }
+    if (merry_loader_get_timeout(request->regs[Mb]) != 0)
+        return merry_os_call_timed(os, request, function, request->regs[Mb], merry_loader_get_sig(request->regs[Mb]));
+    return merry_os_call_slot(os->data_mem, function, request->regs[Mb], request->regs);
+}
+
+_os_exec_(dynsig)
+{
+    // the slot is in Mb and the address of the signature in Ma
+    mbptr_t desc = merry_dmemory_get_byte_address(os->data_mem, request->regs[Ma]);
+    if (desc == NULL)
+    {
+        merry_requestHdlr_panic(os->data_mem->error);
+        return RET_FAILURE;
+    }
+    if (merry_loader_set_sig(request->regs[Mb], (mstr_t)desc) == mfalse)
+    {
+        merry_requestHdlr_panic(MERRY_DYNSIG_FAILED);
+        return RET_FAILURE;
+    }
+    return RET_SUCCESS;
+}
+
+_os_exec_(dyntimeout)
+{
+    // the slot is in Mb and the timeout in milliseconds in Mc
+    if (merry_loader_set_timeout(request->regs[Mb], request->regs[Mc]) == mfalse)
+    {
+        merry_requestHdlr_panic(MERRY_INVALID_DYNSLOT);
+        return RET_FAILURE;
+    }
+    return RET_SUCCESS;
+}
+
+/// NOTE: It is the program's job to not mess with the handle returned by dynl. The VM might crash or undefined behaviour could occur. File handles, on the other hand,
+// are indices into the VM's own table of open files and so an invalid one is caught
 
 _os_exec_(fopen)
 {
@@ -91,84 +329,237 @@ _os_exec_(fopen)
     // the handle will be returned in the Mb register and the return value in the Ma register
     // the VM won't exit on open failure
     // the filename must be null terminated
-    mbptr_t file_name = merry_dmemory_get_byte_address(os->data_mem, os->cores[request->id]->registers[Ma]);
-    mstr_t open_mode = _openmode_((os->cores[request->id]->registers[Mb] & 0b111));
-    FILE *temp = fopen(file_name, open_mode);
-    if (temp == NULL)
+    mbptr_t file_name = merry_dmemory_get_byte_address(os->data_mem, request->regs[Ma]);
+    if (file_name == RET_NULL)
     {
-        os->cores[request->id]->registers[Mb] = 0; // representing NULL
-        os->cores[request->id]->registers[Ma] = 1; // representing Failure
+        merry_requestHdlr_panic(os->data_mem->error);
         return RET_FAILURE;
     }
-    else
+    mqword_t handle = merry_file_open((mcstr_t)file_name, request->regs[Mb] & 0b111);
+    if (handle == 0)
     {
-        os->cores[request->id]->registers[Mb] = (mqword_t)temp; // store the handle
-        os->cores[request->id]->registers[Ma] = 0;              // representing success
+        request->regs[Mb] = 0; // representing NULL
+        request->regs[Ma] = 1; // representing Failure
+        return RET_FAILURE;
     }
+    request->regs[Mb] = handle; // store the handle
+    request->regs[Ma] = 0;      // representing success
     return RET_SUCCESS;
 }
 
+_MERRY_INTERNAL_ MerryFile *merry_os_get_file(mqword_t handle)
+{
+    // every file operation panics if the handle doesn't belong to an open file
+    MerryFile *file = merry_file_get(handle);
+    if (file == RET_NULL)
+        merry_requestHdlr_panic(handle == 0 ? MERRY_FILEHANDLE_NULL : MERRY_INVALID_FILEHANDLE);
+    return file;
+}
+
+_MERRY_INTERNAL_ MerryFile *merry_os_hold_file(mqword_t handle, msize_t *refs)
+{
+    // the same for a file that must be held
+    MerryFile *file = merry_file_hold(handle, refs);
+    if (file == RET_NULL)
+        merry_requestHdlr_panic(handle == 0 ? MERRY_FILEHANDLE_NULL : MERRY_INVALID_FILEHANDLE);
+    return file;
+}
+
 _os_exec_(fclose)
 {
     // the handle to the file to close must be in the Mb register
-    register mqword_t handle = os->cores[request->id]->registers[Mb];
-    if ((mqptr_t)handle == NULL)
-    {
-        // if it is 0 then it is not a good practice to close a NULL file
-        merry_requestHdlr_panic(MERRY_FILEHANDLE_NULL);
+    if (merry_os_get_file(request->regs[Mb]) == RET_NULL)
         return RET_FAILURE;
-    }
-    fclose((FILE *)handle);
+    merry_file_close(request->regs[Mb]);
     return RET_SUCCESS;
 }
 
-_os_exec_(fread)
+_MERRY_INTERNAL_ mret_t merry_os_file_rw(Merry *os, MerryOSRequest *request, mqword_t offset, mbool_t is_read)
 {
-    // if the file handle is NULL, error is thrown
     // The file handle is in the Mb register
-    // The address to store the read contents should be in the Ma register
-    // The number of bytes to read should be in the Mc register
-    // The number of bytes read will be in the Ma register
-    register mqword_t handle = os->cores[request->id]->registers[Mb];
-    if ((mqptr_t)handle == NULL)
+    // The address to read into or write from should be in the Ma register
+    // The number of bytes should be in the Mc register and they may go across any number of pages
+    // The number of bytes that went through will be in the Ma register
+    MerryIOVec iov[_MERRY_FILE_IOV_MAX_];
+    msize_t count;
+    MerryFile *file = merry_os_get_file(request->regs[Mb]);
+    if (file == RET_NULL)
+        return RET_FAILURE;
+    if (merry_dmemory_get_span(os->data_mem, request->regs[Ma], request->regs[Mc], is_read, iov, _MERRY_FILE_IOV_MAX_, &count) == RET_FAILURE)
     {
-        // if it is 0 then it is not a good practice to close a NULL file
-        merry_requestHdlr_panic(MERRY_FILEHANDLE_NULL);
+        merry_requestHdlr_panic(os->data_mem->error);
         return RET_FAILURE;
     }
-    mbptr_t store_in = merry_dmemory_get_byte_address(os->data_mem, os->cores[request->id]->registers[Ma]);
-    register msize_t bytes_to_read = os->cores[request->id]->registers[Mc];
-    os->cores[request->id]->registers[Ma] = fread(store_in, 1, bytes_to_read, (FILE *)handle);
+    request->regs[Ma] = (is_read == mtrue) ? merry_file_read(file, iov, count, offset) : merry_file_write(file, iov, count, offset);
     return RET_SUCCESS;
 }
 
+_os_exec_(fread)
+{
+    // continues from the file's position
+    return merry_os_file_rw(os, request, _MERRY_FILE_CUR_POS_, mtrue);
+}
+
 _os_exec_(fwrite)
 {
     // exactly the same but write is performed instead
-    register mqword_t handle = os->cores[request->id]->registers[Mb];
-    if ((mqptr_t)handle == NULL)
+    return merry_os_file_rw(os, request, _MERRY_FILE_CUR_POS_, mfalse);
+}
+
+_os_exec_(fpread)
+{
+    // the same as fread but the offset is in the Md register and the file's position is left alone
+    return merry_os_file_rw(os, request, request->regs[Md], mtrue);
+}
+
+_os_exec_(fpwrite)
+{
+    return merry_os_file_rw(os, request, request->regs[Md], mfalse);
+}
+
+_os_exec_(fseek)
+{
+    // handle in Mb, the offset(signed) in Mc and where it is from in Md(0: start, 1: current position, 2: end)
+    // the new position is returned in Ma or all ones on failure
+    MerryFile *file = merry_os_get_file(request->regs[Mb]);
+    if (file == RET_NULL)
+        return RET_FAILURE;
+    if (merry_file_seek(file, (msqword_t)request->regs[Mc], request->regs[Md], &request->regs[Ma]) == RET_FAILURE)
+        request->regs[Ma] = (mqword_t)-1;
+    return RET_SUCCESS;
+}
+
+_os_exec_(ftell)
+{
+    // handle in Mb and the position is returned in Ma
+    MerryFile *file = merry_os_get_file(request->regs[Mb]);
+    if (file == RET_NULL)
+        return RET_FAILURE;
+    request->regs[Ma] = atomic_load(&file->pos);
+    return RET_SUCCESS;
+}
+
+_os_exec_(fsize)
+{
+    // handle in Mb and the size is returned in Ma or all ones on failure
+    MerryFile *file = merry_os_get_file(request->regs[Mb]);
+    if (file == RET_NULL)
+        return RET_FAILURE;
+    if (merry_file_size(file, &request->regs[Ma]) == RET_FAILURE)
+        request->regs[Ma] = (mqword_t)-1;
+    return RET_SUCCESS;
+}
+
+_MERRY_INTERNAL_ mret_t merry_os_file_rwv(Merry *os, MerryOSRequest *request, mbool_t is_read)
+{
+    // The file handle is in the Mb register
+    // The address of the list of buffers should be in the Ma register and the number of buffers in the Mc register
+    // Each buffer is two qwords: its address followed by its length. The list must be 8-byte aligned
+    // A buffer that goes across pages takes up one host buffer for every page and all of them together can't take more than _MERRY_FILE_IOV_MAX_
+    // The total number of bytes that went through will be in the Ma register
+    MerryIOVec iov[_MERRY_FILE_IOV_MAX_];
+    msize_t total = 0, count;
+    MerryFile *file = merry_os_get_file(request->regs[Mb]);
+    if (file == RET_NULL)
+        return RET_FAILURE;
+    register msize_t list_len = request->regs[Mc];
+    if (list_len > _MERRY_FILE_IOV_MAX_)
+    {
+        merry_requestHdlr_panic(MERRY_INVALID_IOV);
+        return RET_FAILURE;
+    }
+    mqptr_t list = merry_dmemory_get_qword_address_bounds(os->data_mem, request->regs[Ma], list_len * 2);
+    if (list == RET_NULL)
     {
-        // if it is 0 then it is not a good practice to close a NULL file
-        merry_requestHdlr_panic(MERRY_FILEHANDLE_NULL);
+        merry_requestHdlr_panic(os->data_mem->error);
         return RET_FAILURE;
     }
-    mbptr_t to_write = merry_dmemory_get_byte_address(os->data_mem, os->cores[request->id]->registers[Ma]);
-    register msize_t bytes_to_read = os->cores[request->id]->registers[Mc];
-    os->cores[request->id]->registers[Ma] = fwrite(to_write, 1, bytes_to_read, (FILE *)handle);
+    for (msize_t i = 0; i < list_len; i++)
+    {
+        if (merry_dmemory_get_span(os->data_mem, list[i * 2], list[i * 2 + 1], is_read, iov + total, _MERRY_FILE_IOV_MAX_ - total, &count) == RET_FAILURE)
+        {
+            merry_requestHdlr_panic(os->data_mem->error);
+            return RET_FAILURE;
+        }
+        total += count;
+    }
+    request->regs[Ma] = (is_read == mtrue) ? merry_file_read(file, iov, total, _MERRY_FILE_CUR_POS_) : merry_file_write(file, iov, total, _MERRY_FILE_CUR_POS_);
     return RET_SUCCESS;
 }
 
+_os_exec_(freadv)
+{
+    return merry_os_file_rwv(os, request, mtrue);
+}
+
+_os_exec_(fwritev)
+{
+    return merry_os_file_rwv(os, request, mfalse);
+}
+
 _os_exec_(feof)
 {
     // handle in Mb register
     // nonzero in Ma if eof else 0
-    register mqword_t handle = os->cores[request->id]->registers[Mb];
-    if ((mqptr_t)handle == NULL)
+    MerryFile *file = merry_os_get_file(request->regs[Mb]);
+    if (file == RET_NULL)
+        return RET_FAILURE;
+    request->regs[Ma] = atomic_load(&file->eof);
+    return RET_SUCCESS;
+}
+
+_os_exec_(fcopy)
+{
+    // the handle of the file to copy to is in Mb, the handle of the file to copy from in Mc and the number of bytes in Md
+    // the bytes are copied from the position of one to the position of the other and both of them are moved
+    // the number of bytes copied is returned in Ma
+    // the source isn't on this request's key and so it could be closed on another thread; both are held for the whole copy
+    msize_t refs;
+    MerryFile *to = merry_os_hold_file(request->regs[Mb], &refs);
+    if (to == RET_NULL)
+        return RET_FAILURE;
+    MerryFile *from = merry_os_hold_file(request->regs[Mc], &refs);
+    if (from == RET_NULL)
     {
-        // if it is 0 then it is not a good practice to close a NULL file
-        merry_requestHdlr_panic(MERRY_FILEHANDLE_NULL);
+        merry_file_drop(to);
+        return RET_FAILURE;
+    }
+    // with one position for both there is nowhere to copy to that isn't being read from
+    request->regs[Ma] = (to == from) ? 0 : merry_file_copy(to, from, request->regs[Md]);
+    merry_file_drop(from);
+    merry_file_drop(to);
+    return RET_SUCCESS;
+}
+
+_os_exec_(fmap)
+{
+    // handle in Mb, the address of the first page to map to in Ma, the number of bytes in Mc, the offset into the file in Md and the mode in Me
+    // mode 0 is read-only and anything else is copy-on-write; the file itself is never changed either way
+    // Ma will contain 0 on success and 1 on failure
+    // this isn't on the handle's key and so the file is held until the mapping is made as it could be closed on another thread
+    msize_t refs;
+    MerryFile *file = merry_os_hold_file(request->regs[Mb], &refs);
+    if (file == RET_NULL)
         return RET_FAILURE;
+    mqword_t size;
+    mqword_t offset = request->regs[Md];
+    msize_t len = request->regs[Mc];
+    if (merry_file_size(file, &size) == RET_FAILURE || offset >= size)
+        request->regs[Ma] = 1;
+    else
+    {
+        // anything past the end of the file is zeroed
+        msize_t file_len = (size - offset < len) ? size - offset : len;
+        request->regs[Ma] = merry_dmemory_map_file(os->data_mem, request->regs[Ma], len, file->fd, offset, file_len, request->regs[Me] == 0) == RET_FAILURE;
     }
-    os->cores[request->id]->registers[Ma] = feof((FILE *)handle);
+    merry_file_drop(file);
     return RET_SUCCESS;
-}
\ No newline at end of file
+}
+
+_os_exec_(funmap)
+{
+    // the address of the first page in Ma and the number of bytes in Mc
+    // the pages are zeroed and Ma will contain 0 on success and 1 on failure
+    request->regs[Ma] = merry_dmemory_unmap(os->data_mem, request->regs[Ma], request->regs[Mc]) == RET_FAILURE;
+    return RET_SUCCESS;
+}
@@ -21,7 +21,8 @@ _MERRY_INTERNAL_ mret_t merry_reader_alloc_pages(MerryInpFile *inp)
     // after parsing the input file, we need to map the memory pages and prepare for reading
     // In the future, the input files, if gets too large, we have to implement some optimizations for them
     // for example, the reader can read the file in the background and fill the memory as the VM is executing simultaneously
-    msize_t aligned = merry_align_size(inp->dlen) + inp->slen; // data includes slen as well
+    // the BSS pages are mapped like the others but nothing is ever written to them so the host zero-fills them only when the program touches them
+    msize_t aligned = (merry_align_size(inp->dlen)) + inp->slen + inp->bsslen; // data includes slen and bsslen as well
     inp->dpage_count = aligned / _MERRY_MEMORY_ADDRESSES_PER_PAGE_ + (aligned % _MERRY_MEMORY_ADDRESSES_PER_PAGE_ > 0 ? 1 : 0);
     inp->ipage_count = inp->ilen / _MERRY_MEMORY_ADDRESSES_PER_PAGE_ + (inp->ilen % _MERRY_MEMORY_ADDRESSES_PER_PAGE_ > 0 ? 1 : 0);
     // even if dpage_count is 0, we sill need to map one page
@@ -71,6 +72,10 @@ void merry_destory_reader(MerryInpFile *inp)
     {
         free(inp->_instructions);
     }
+    if (inp->chunks != NULL)
+    {
+        free(inp->chunks);
+    }
     free(inp);
 }
 
@@ -123,6 +128,15 @@ _MERRY_INTERNAL_ mret_t merry_reader_parse_header(MerryInpFile *inp)
         return RET_FAILURE;
     }
     // the file has the signature bytes
+    inp->flags = header[_READER_FLAGS_BYTE_];
+    if ((inp->flags & ~_READER_KNOWN_FLAGS_) != 0)
+    {
+        // the file was made for a newer version of merry
+        read_msg("Read Error: The input file '%s' uses unknown header flags 0x%02x.\n", inp->_file_name, inp->flags & ~_READER_KNOWN_FLAGS_);
+        return RET_FAILURE;
+    }
+    // files without the flag are in whatever ordering merry is configured to expect
+    inp->byte_order = (inp->flags & _READER_FLAG_NATIVE_LE_) ? _INP_FILE_ORDERING_LITTLE_ : _MERRY_ENDIANNESS_;
     // now get the ilen and dlen from SDT
     inp->ilen = header[8];
     inp->ilen = (inp->ilen << 8) | header[9];
@@ -152,7 +166,8 @@ _MERRY_INTERNAL_ mret_t merry_reader_parse_header(MerryInpFile *inp)
     inp->slen = (inp->slen << 8) | header[30];
     inp->slen = (inp->slen << 8) | header[31];
     // now check if dlen and ilen are within the limits
-    if (inp->file_len < (inp->dlen + inp->ilen + inp->slen))
+    // files with an extended header are checked after the extended header is parsed
+    if ((inp->flags & _READER_EXT_FLAGS_) == 0 && inp->file_len < (_READER_HEADER_LEN_ + inp->dlen + inp->ilen + inp->slen))
     {
         _READ_DIRERROR_("Read Error: Invalid instruction and data length.\n");
         return RET_FAILURE;
@@ -176,368 +191,256 @@ _MERRY_INTERNAL_ mret_t merry_reader_parse_header(MerryInpFile *inp)
     return RET_SUCCESS;
 }
 
-_MERRY_INTERNAL_ mret_t merry_reader_read_instructions_same(MerryInpFile *inp)
+_MERRY_INTERNAL_ mret_t merry_reader_read_at(MerryInpFile *inp, mbptr_t buf, msize_t len, msize_t offset)
 {
-    // we need to know how many pages to read
-    // we have ipage_count but we still have to redo the calculations
-    msize_t count = inp->ilen / _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
-    msize_t ext = inp->ilen % _MERRY_MEMORY_ADDRESSES_PER_PAGE_; // this gives any remaining addresses
-    for (msize_t i = 0; i < count; i++)
-    {
-        // now we read
-        // we have already made sure that this is within the limits of the input file
-        if (fread(inp->_instructions[i], 1, _MERRY_MEMORY_ADDRESSES_PER_PAGE_, inp->f) != _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
-        {
-            // we failed
-            // what should we do when we fail to read?
-            _READ_DIRERROR_("Read Error: Error while reading instructions.\n");
-            return RET_FAILURE;
-        }
-    }
-    // now this will read any remaining ones
-    if (ext > 0)
+    // read len bytes at offset into buf
+    // pread doesn't touch the stream's position and so every loader thread can read from the same file simultaneously
+#if defined(_MERRY_HOST_OS_LINUX_)
+    while (len > 0)
     {
-        if (fread(inp->_instructions[count], 1, ext, inp->f) != ext)
-        {
-            _READ_DIRERROR_("Read Error: Error while reading instructions.\n");
-            return RET_FAILURE;
-        }
+        ssize_t got = pread(fileno(inp->f), buf, len, offset);
+        if (got <= 0)
+            return RET_FAILURE; // error or unexpected EOF
+        buf += got;
+        offset += got;
+        len -= got;
     }
-    // in future, if we do optimize reader for faster file reading, we can make this function run as a detached thread constantly reading in the background
-    return RET_SUCCESS; // we did it!
+    return RET_SUCCESS;
+#else
+    // there is only one loader thread on other hosts so seeking is fine
+    if (fseek(inp->f, offset, SEEK_SET) != 0)
+        return RET_FAILURE;
+    return fread(buf, 1, len, inp->f) == len ? RET_SUCCESS : RET_FAILURE;
+#endif
 }
 
-_MERRY_INTERNAL_ mret_t merry_reader_read_instructions_different(MerryInpFile *inp)
+_MERRY_INTERNAL_ msize_t merry_reader_be64(mbptr_t bytes)
 {
-    // read instructions when the ordering of the bytes in the input file is different than that of the host
-    // this is not preferable but we can do nothing
-    register msize_t count = inp->ilen / _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
-    register msize_t ext = inp->ilen % _MERRY_MEMORY_ADDRESSES_PER_PAGE_; // this gives any remaining addresses
-    // how should we approach this? All i can think of is, read 8 bytes, invert them, and write it to the mapped pages
-    mbyte_t num[_MERRY_MEMORY_ADDRESSES_PER_PAGE_];
-    mqword_t inverted[_MERRY_MEMORY_QS_PER_PAGE_];
-    for (msize_t i = 0; i < count; i++)
-    {
-        if (fread(num, 1, _MERRY_MEMORY_ADDRESSES_PER_PAGE_, inp->f) != _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
-        {
-            _READ_DIRERROR_("Read Error: Error while reading instructions.\n");
-            return RET_FAILURE;
-        }
-        // now we have to invert the order of the bytes
-        // now invert all those bytes
-        msize_t k = 0;
-        for (msize_t j = 0; j < _MERRY_MEMORY_QS_PER_PAGE_; j++)
-        {
-            inverted[j] = num[k];
-            inverted[j] = (inverted[j] << 8) | num[k + 1];
-            inverted[j] = (inverted[j] << 8) | num[k + 2];
-            inverted[j] = (inverted[j] << 8) | num[k + 3];
-            inverted[j] = (inverted[j] << 8) | num[k + 4];
-            inverted[j] = (inverted[j] << 8) | num[k + 5];
-            inverted[j] = (inverted[j] << 8) | num[k + 6];
-            inverted[j] = (inverted[j] << 8) | num[k + 7];
-            k += 8;
-        }
-        // with the inverted ones, now write them to the mapped memory pages
-        if (memcpy(inp->_instructions[i], (mbptr_t)inverted, _MERRY_MEMORY_ADDRESSES_PER_PAGE_) != inp->_instructions[i])
-        {
-            // we failed here
-            _READ_DIRERROR_("Read Error: Failed to read instructions.\n");
-            return RET_FAILURE;
-        }
-    }
-    if (ext > 0)
-    {
-        // we have more left
-        if (fread(num, 1, ext, inp->f) != ext)
-        {
-            _READ_DIRERROR_("Read Error: Error while reading instructions.\n");
-            return RET_FAILURE;
-        }
-        msize_t k = 0;
-        for (msize_t j = 0; j < (ext / 8); j++)
-        {
-            inverted[j] = num[k];
-            inverted[j] = (inverted[j] << 8) | num[k + 1];
-            inverted[j] = (inverted[j] << 8) | num[k + 2];
-            inverted[j] = (inverted[j] << 8) | num[k + 3];
-            inverted[j] = (inverted[j] << 8) | num[k + 4];
-            inverted[j] = (inverted[j] << 8) | num[k + 5];
-            inverted[j] = (inverted[j] << 8) | num[k + 6];
-            inverted[j] = (inverted[j] << 8) | num[k + 7];
-            k += 8;
-        }
-        // with the inverted ones, now write them to the mapped memory pages
-        if (memcpy(inp->_instructions[count], (mbptr_t)inverted, ext) != inp->_instructions[count])
-        {
-            // we failed here
-            _READ_DIRERROR_("Read Error: Failed to read instructions.\n");
-            return RET_FAILURE;
-        }
-    }
-    return RET_SUCCESS; // this should read the bytes properly
+    msize_t val = 0;
+    for (msize_t i = 0; i < 8; i++)
+        val = (val << 8) | bytes[i];
+    return val;
 }
 
-_MERRY_INTERNAL_ mret_t merry_reader_read_inst(MerryInpFile *inp)
+_MERRY_INTERNAL_ msize_t merry_reader_page_count(msize_t len)
 {
-    // read the instructions which comes first
-    // after reading the header along with SDT, we now have all the information needed to read the file
-    // first check if the byte ordering of the input bytes is the same as that of the host
-    mret_t ret;
-    // check if we succeeded
-    if (_MERRY_BYTE_ORDER_ == _MERRY_ENDIANNESS_)
-        ret = merry_reader_read_instructions_same(inp);
-    else
-        ret = merry_reader_read_instructions_different(inp);
-    if (ret == RET_SUCCESS)
-        return ret;
-    // failed
-    // free the mapped pages
-    merry_reader_unalloc_pages(inp);
-    return ret;
+    return len / _MERRY_MEMORY_ADDRESSES_PER_PAGE_ + (len % _MERRY_MEMORY_ADDRESSES_PER_PAGE_ > 0 ? 1 : 0);
 }
 
-_MERRY_INTERNAL_ mret_t merry_reader_read_data_different(MerryInpFile *inp)
+_MERRY_INTERNAL_ msize_t merry_reader_page_len(msize_t len, msize_t index)
 {
-    // read instructions when the ordering of the bytes in the input file is different than that of the host
-    // this is not preferable but we can do nothing
-    register msize_t count = inp->dlen / _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
-    register msize_t ext = inp->dlen % _MERRY_MEMORY_ADDRESSES_PER_PAGE_; // this gives any remaining addresses
-    // how should we approach this? All i can think of is, read 8 bytes, invert them, and write it to the mapped pages
-    mbyte_t num[_MERRY_MEMORY_ADDRESSES_PER_PAGE_];
-    mqword_t inverted[_MERRY_MEMORY_QS_PER_PAGE_];
-    for (msize_t i = 0; i < count; i++)
-    {
-        if (fread(num, 1, _MERRY_MEMORY_ADDRESSES_PER_PAGE_, inp->f) != _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
-        {
-            _READ_DIRERROR_("Read Error: Error while reading data.\n");
-            return RET_FAILURE;
-        }
-        // now we have to invert the order of the bytes
-        // now invert all those bytes
-        msize_t k = 0;
-        for (msize_t j = 0; j < _MERRY_MEMORY_QS_PER_PAGE_; j++)
-        {
-            inverted[j] = num[k];
-            inverted[j] = (inverted[j] << 8) | num[k + 1];
-            inverted[j] = (inverted[j] << 8) | num[k + 2];
-            inverted[j] = (inverted[j] << 8) | num[k + 3];
-            inverted[j] = (inverted[j] << 8) | num[k + 4];
-            inverted[j] = (inverted[j] << 8) | num[k + 5];
-            inverted[j] = (inverted[j] << 8) | num[k + 6];
-            inverted[j] = (inverted[j] << 8) | num[k + 7];
-            k += 8;
-        }
-        // with the inverted ones, now write them to the mapped memory pages
-        if (memcpy(inp->_data[i], inverted, _MERRY_MEMORY_ADDRESSES_PER_PAGE_) != inp->_data[i])
-        {
-            // we failed here
-            _READ_DIRERROR_("Read Error: Failed to read data bytes.\n");
-            return RET_FAILURE;
-        }
-    }
-    if (ext > 0)
-    {
-        // we have more left
-        if (fread(num, 1, ext, inp->f) != ext)
-        {
-            _READ_DIRERROR_("Read Error: Error while reading data.\n");
-            return RET_FAILURE;
-        }
-        msize_t k = 0;
-        for (msize_t j = 0; j < (ext / 8); j++)
-        {
-            inverted[j] = num[k];
-            inverted[j] = (inverted[j] << 8) | num[k + 1];
-            inverted[j] = (inverted[j] << 8) | num[k + 2];
-            inverted[j] = (inverted[j] << 8) | num[k + 3];
-            inverted[j] = (inverted[j] << 8) | num[k + 4];
-            inverted[j] = (inverted[j] << 8) | num[k + 5];
-            inverted[j] = (inverted[j] << 8) | num[k + 6];
-            inverted[j] = (inverted[j] << 8) | num[k + 7];
-            k += 8;
-        }
-        // with the inverted ones, now write them to the mapped memory pages
-        if (memcpy(inp->_data[count], inverted, ext) != inp->_data[count])
-        {
-            // we failed here
-            _READ_DIRERROR_("Read Error: Failed to read data.\n");
-            return RET_FAILURE;
-        }
-    }
+    // the number of bytes of a section of len bytes that fall in its index'th page
+    msize_t start = index * _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
+    return (len - start) > _MERRY_MEMORY_ADDRESSES_PER_PAGE_ ? _MERRY_MEMORY_ADDRESSES_PER_PAGE_ : (len - start);
+}
 
-    // we will read string here
-    if (inp->slen == 0)
+_MERRY_INTERNAL_ mret_t merry_reader_parse_ext_header(MerryInpFile *inp)
+{
+    // Some flags need more information than the 32 bytes of the header can hold and so the header is followed by an extended header
+    // The extended header is made of 8-byte big endian words where the first word is the length of the extended header in bytes
+    // The rest depends on the flags, see docs/input_file_format.txt
+    mbyte_t word[8];
+    mbptr_t ext = RET_NULL;
+    msize_t pos = 8;
+    if ((inp->flags & _READER_EXT_FLAGS_) == 0)
         return RET_SUCCESS;
-
-    // firstly read
-    mqword_t rem = _MERRY_MEMORY_ADDRESSES_PER_PAGE_ - ext;
-
-    if (fread(inp->_data[count] + (ext / 8), 1, rem < inp->slen ? rem : inp->slen, inp->f) != (rem < inp->slen ? rem : inp->slen))
+    if (merry_reader_read_at(inp, word, 8, _READER_HEADER_LEN_) == RET_FAILURE)
+        goto invalid;
+    inp->ext_len = merry_reader_be64(word);
+    if (inp->ext_len < 8 || inp->ext_len % 8 != 0 || inp->ext_len > inp->file_len - _READER_HEADER_LEN_)
+        goto invalid;
+    if ((ext = (mbptr_t)malloc(inp->ext_len)) == RET_NULL)
     {
-        _READ_DIRERROR_("Read Error: Failed to read string.\n");
+        read_internal_error("Unable to read the extended header");
         return RET_FAILURE;
     }
-
-    if (inp->slen < rem)
-        return RET_SUCCESS; // we have read what we can
-
-    // we have read another page now
-    inp->slen -= rem; // we have read rem number of bytes already
-
-    register msize_t s_count = inp->slen / _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
-    register msize_t s_ext = inp->slen % _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
-    count++;
-    for (msize_t i = 0; i < (s_count); i++)
+    if (merry_reader_read_at(inp, ext, inp->ext_len, _READER_HEADER_LEN_) == RET_FAILURE)
+        goto invalid;
+    msize_t payload = _READER_HEADER_LEN_ + inp->ext_len; // where the instructions start
+    if (inp->flags & _READER_FLAG_BSS_)
     {
-        if (fread(inp->_data[count], 1, _MERRY_MEMORY_ADDRESSES_PER_PAGE_, inp->f) != _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
-        {
-            // we failed
-            // what should we do when we fail to read?
-            _READ_DIRERROR_("Read Error: Failed to read string data.\n");
-            return RET_FAILURE;
-        }
-        count++;
+        if (inp->ext_len - pos < 8)
+            goto invalid;
+        inp->bsslen = merry_reader_be64(ext + pos);
+        pos += 8;
+        // make sure that the size of the data memory doesn't overflow
+        if (inp->bsslen > ~(msize_t)0 - _MERRY_MEMORY_ADDRESSES_PER_PAGE_ - (inp->dlen + inp->slen))
+            goto invalid;
     }
-
-    if (s_ext > 0)
+    if (inp->flags & _READER_FLAG_COMPRESSED_)
     {
-        if (fread(inp->_data[count], 1, s_ext, inp->f) != s_ext)
+        // the compressed length of every instruction page followed by every data page
+        // the chunks follow the extended header in the same order
+        msize_t icount = merry_reader_page_count(inp->ilen);
+        msize_t count = icount + merry_reader_page_count(inp->dlen + inp->slen);
+        if ((inp->ext_len - pos) / 8 < count)
+            goto invalid;
+        if ((inp->chunks = (MerryReaderChunk *)malloc(sizeof(MerryReaderChunk) * count)) == RET_NULL)
         {
-            _READ_DIRERROR_("Read Error: Failed to read string data.\n");
+            free(ext);
+            read_internal_error("Unable to read the extended header");
             return RET_FAILURE;
         }
+        for (msize_t i = 0; i < count; i++, pos += 8)
+        {
+            msize_t page_len = i < icount ? merry_reader_page_len(inp->ilen, i) : merry_reader_page_len(inp->dlen + inp->slen, i - icount);
+            inp->chunks[i].offset = payload;
+            inp->chunks[i].len = merry_reader_be64(ext + pos);
+            if (inp->chunks[i].len == 0 || inp->chunks[i].len > page_len)
+                goto invalid;
+            payload += inp->chunks[i].len;
+        }
+        if (payload > inp->file_len)
+            goto invalid;
     }
+    else if (inp->file_len < (payload + inp->dlen + inp->ilen + inp->slen))
+        goto invalid;
+    free(ext);
+    return RET_SUCCESS;
+invalid:
+    if (ext != RET_NULL)
+        free(ext);
+    read_msg("Read Error: The input file '%s' has an invalid extended header.\n", inp->_file_name);
+    return RET_FAILURE;
+}
 
-    return RET_SUCCESS; // this should read the bytes properly
+_MERRY_INTERNAL_ mret_t merry_reader_fill_page(MerryInpFile *inp, mbptr_t page, msize_t len, msize_t offset, msize_t chunk, mbptr_t scratch)
+{
+    // fill a page with len bytes that are at offset in an uncompressed file or in the chunk'th chunk in a compressed file
+    if (inp->chunks == RET_NULL)
+        return merry_reader_read_at(inp, page, len, offset);
+    MerryReaderChunk *c = &inp->chunks[chunk];
+    if (c->len == len)
+        return merry_reader_read_at(inp, page, len, c->offset); // this one didn't compress and is stored as is
+    if (merry_reader_read_at(inp, scratch, c->len, c->offset) == RET_FAILURE)
+        return RET_FAILURE;
+    return merry_lz4_decompress(scratch, c->len, page, len);
 }
 
-_MERRY_INTERNAL_ mret_t merry_reader_read_data_same(MerryInpFile *inp)
+_MERRY_INTERNAL_ mret_t merry_reader_load_page(MerryInpFile *inp, msize_t index, mbptr_t scratch)
 {
-    register msize_t count = inp->dlen / _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
-    register msize_t ext = inp->dlen % _MERRY_MEMORY_ADDRESSES_PER_PAGE_; // this gives any remaining addresses
-    for (msize_t i = 0; i < count; i++)
+    // the pages are numbered with all the instruction pages first followed by the data pages
+    // The data section and the string section are contiguous in both the file and the memory and so they are loaded together
+    // only the bytes belonging to the data section are inverted, the string section is read as is
+    if (index < inp->ipage_count)
     {
-        // now we read
-        // we have already made sure that this is within the limits of the input file
-        if (fread(inp->_data[i], 1, _MERRY_MEMORY_ADDRESSES_PER_PAGE_, inp->f) != _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
+        msize_t start = index * _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
+        msize_t len = inp->ilen - start;
+        if (len > _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
+            len = _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
+        if (merry_reader_fill_page(inp, (mbptr_t)inp->_instructions[index], len, _READER_HEADER_LEN_ + inp->ext_len + start, index, scratch) == RET_FAILURE)
         {
-            // we failed
-            // what should we do when we fail to read?
-            _READ_DIRERROR_("Read Error: Failed to read data.\n");
-            return RET_FAILURE;
-        }
-    }
-    // now this will read any remaining ones
-    if (ext > 0)
-    {
-        if (fread(inp->_data[count], 1, ext, inp->f) != ext)
-        {
-            _READ_DIRERROR_("Read Error: Failed to read data.\n");
+            _READ_DIRERROR_("Read Error: Error while reading instructions.\n");
             return RET_FAILURE;
         }
-    }
-    // we will read string here
-    if (inp->slen == 0)
+        if (inp->invert == mtrue)
+            merry_bswap64(inp->_instructions[index], len / 8);
         return RET_SUCCESS;
-
-    // firstly read
-    mqword_t rem = _MERRY_MEMORY_ADDRESSES_PER_PAGE_ - ext;
-
-    if (fread(inp->_data[count] + (ext / 8), 1, rem < inp->slen ? rem : inp->slen, inp->f) != (rem < inp->slen ? rem : inp->slen))
+    }
+    index -= inp->ipage_count;
+    msize_t start = index * _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
+    msize_t total = inp->dlen + inp->slen;
+    if (start >= total)
+        return RET_SUCCESS; // nothing to read for this page
+    msize_t len = total - start;
+    if (len > _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
+        len = _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
+    if (merry_reader_fill_page(inp, (mbptr_t)inp->_data[index], len, _READER_HEADER_LEN_ + inp->ext_len + inp->ilen + start, inp->ipage_count + index, scratch) == RET_FAILURE)
     {
-        _READ_DIRERROR_("Read Error: Failed to read string.\n");
+        _READ_DIRERROR_("Read Error: Failed to read data.\n");
         return RET_FAILURE;
     }
-
-    // for (msize_t i = 0; i < 7; i++)
-    // {
-    //     printf("%lX\n", inp->_data[count][i]);
-    // }
-
-    if (inp->slen < rem)
-        return RET_SUCCESS; // we have read what we can
-
-    // we have read another page now
-    inp->slen -= rem; // we have read rem number of bytes already
-
-    register msize_t s_count = inp->slen / _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
-    register msize_t s_ext = inp->slen % _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
-    count++;
-    for (msize_t i = 0; i < (s_count); i++)
+    if (inp->invert == mtrue && start < inp->dlen)
     {
-        if (fread(inp->_data[count], 1, _MERRY_MEMORY_ADDRESSES_PER_PAGE_, inp->f) != _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
-        {
-            // we failed
-            // what should we do when we fail to read?
-            _READ_DIRERROR_("Read Error: Failed to read string data.\n");
-            return RET_FAILURE;
-        }
-        count++;
+        msize_t dbytes = inp->dlen - start;
+        merry_bswap64(inp->_data[index], (dbytes < len ? dbytes : len) / 8);
     }
+    return RET_SUCCESS;
+}
 
-    if (s_ext > 0)
+_MERRY_INTERNAL_ _THRET_T_ merry_reader_loader(mptr_t arg)
+{
+    MerryReaderJob *job = (MerryReaderJob *)arg;
+    job->ret = RET_SUCCESS;
+    // the compressed chunks are never longer than a page
+    if (job->inp->chunks != RET_NULL && (job->scratch = (mbptr_t)malloc(_MERRY_MEMORY_ADDRESSES_PER_PAGE_)) == RET_NULL)
+        job->ret = RET_FAILURE;
+    for (msize_t i = job->start; i < job->end && job->ret == RET_SUCCESS; i++)
     {
-        if (fread(inp->_data[count], 1, s_ext, inp->f) != s_ext)
-        {
-            _READ_DIRERROR_("Read Error: Failed to read string data.\n");
-            return RET_FAILURE;
-        }
+        if (merry_reader_load_page(job->inp, i, job->scratch) == RET_FAILURE)
+            job->ret = RET_FAILURE;
     }
+    if (job->scratch != RET_NULL)
+        free(job->scratch);
+#if defined(_MERRY_HOST_OS_LINUX_)
+    return RET_NULL;
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+    return 0;
+#endif
+}
 
-    // in future, if we do optimize reader for faster file reading, we can make this function run as a detached thread constantly reading in the background
-    return RET_SUCCESS; // we did it!
+_MERRY_INTERNAL_ msize_t merry_reader_get_thread_count(msize_t page_count)
+{
+    // one thread per page at most and never more than there are host cores
+    msize_t count = 1;
+#if defined(_MERRY_HOST_OS_LINUX_)
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    count = online > 0 ? (msize_t)online : 1;
+#endif
+    if (count > _READER_MAX_THREADS_)
+        count = _READER_MAX_THREADS_;
+    if (count > page_count)
+        count = page_count;
+    return count == 0 ? 1 : count;
 }
 
-// the same process for data reading as well
-_MERRY_INTERNAL_ mret_t merry_reader_read_data(MerryInpFile *inp)
+_MERRY_INTERNAL_ mret_t merry_reader_load(MerryInpFile *inp)
 {
-    // when it comes to data, even though there may be none, we still map one page
-    if ((inp->dlen + inp->slen) == 0)
-        return RET_SUCCESS;
-    mret_t ret;
-    if (_MERRY_BYTE_ORDER_ == _MERRY_ENDIANNESS_)
-        ret = merry_reader_read_data_same(inp);
-    else
-        ret = merry_reader_read_data_different(inp);
-    // the same as instruction reading
+    // Every page is independent of every other page and so the pages are split into disjoint ranges and each range is loaded by a thread of its own
+    // The calling thread also loads the first range instead of just waiting
+    msize_t page_count = inp->ipage_count + inp->dpage_count;
+    msize_t thread_count = merry_reader_get_thread_count(page_count);
+    MerryReaderJob jobs[_READER_MAX_THREADS_];
+    MerryThread threads[_READER_MAX_THREADS_];
+    mbool_t started[_READER_MAX_THREADS_];
+    msize_t per_thread = page_count / thread_count;
+    msize_t extra = page_count % thread_count;
+    msize_t next = 0;
+    for (msize_t i = 0; i < thread_count; i++)
+    {
+        jobs[i].inp = inp;
+        jobs[i].start = next;
+        next += per_thread + (i < extra ? 1 : 0);
+        jobs[i].end = next;
+        jobs[i].ret = RET_SUCCESS;
+        jobs[i].scratch = RET_NULL;
+        started[i] = mfalse;
+    }
+    for (msize_t i = 1; i < thread_count; i++)
+    {
+        // if we fail to start a thread, the job will be done by this thread after its own
+        if (merry_create_thread(&threads[i], &merry_reader_loader, &jobs[i]) == RET_SUCCESS)
+            started[i] = mtrue;
+    }
+    merry_reader_loader(&jobs[0]);
+    mret_t ret = jobs[0].ret;
+    for (msize_t i = 1; i < thread_count; i++)
+    {
+        if (started[i] == mtrue)
+            merry_thread_join(&threads[i], NULL);
+        else
+            merry_reader_loader(&jobs[i]);
+        if (jobs[i].ret == RET_FAILURE)
+            ret = RET_FAILURE;
+    }
     if (ret == RET_SUCCESS)
         return ret;
+    // failed
+    // free the mapped pages
     merry_reader_unalloc_pages(inp);
     return ret;
 }
 
-// _MERRY_INTERNAL_ mret_t merry_reader_read_string(MerryInpFile *inp)
-// {
-//     if (inp->slen == 0)
-//         return RET_SUCCESS;
-//     register msize_t s_count = inp->slen / _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
-//     register msize_t s_ext = inp->slen % _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
-//     // slen will certainly not be that long
-//     register msize_t count = inp->dlen / _MERRY_MEMORY_ADDRESSES_PER_PAGE_;
-//     register msize_t ext = inp->dlen % _MERRY_MEMORY_ADDRESSES_PER_PAGE_; // this gives any remaining addresses
-//     mbyte_t _read[_MERRY_MEMORY_ADDRESSES_PER_PAGE_];
-
-//     mqword_t rem = _MERRY_MEMORY_ADDRESSES_PER_PAGE_ - ext;
-
-//     if (fread(&inp->_data[count - 1][ext - 1], 1, rem < inp->slen ? rem : inp->slen, inp->f) != _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
-//     {
-//         _READ_DIRERROR_("Read Error: Failed to read string.\n");
-//         return RET_FAILURE;
-//     }
-
-//     for (msize_t i = 0; i < s_count; i++)
-//     {
-//         if (fread(inp->_data[i], 1, _MERRY_MEMORY_ADDRESSES_PER_PAGE_, inp->f) != _MERRY_MEMORY_ADDRESSES_PER_PAGE_)
-//         {
-//             // we failed
-//             // what should we do when we fail to read?
-//             _READ_DIRERROR_("Read Error: Failed to read data.\n");
-//             return RET_FAILURE;
-//         }
-//     }
-// }
-
 MerryInpFile *merry_read_file(mcstr_t _file_name)
 {
     // read the input file
@@ -555,6 +458,11 @@ MerryInpFile *merry_read_file(mcstr_t _file_name)
     }
     // we now have to open the file and read it
     inp->_file_name = _file_name;
+    inp->_data = RET_NULL;
+    inp->_instructions = RET_NULL;
+    inp->chunks = RET_NULL;
+    inp->ext_len = 0;
+    inp->bsslen = 0;
     // open the file for reading
     inp->f = fopen(_file_name, "rb");
     if (inp->f == NULL)
@@ -574,12 +482,17 @@ MerryInpFile *merry_read_file(mcstr_t _file_name)
     // read the header
     if (merry_reader_parse_header(inp) != RET_SUCCESS)
         goto failed;
+    if (merry_reader_parse_ext_header(inp) != RET_SUCCESS)
+        goto failed;
+    // we only need to invert if the host's ordering is different from the file's
+    // for little endian files on little endian hosts, the pages are filled straight from the file without touching a single byte
+    inp->invert = (_MERRY_BYTE_ORDER_ == inp->byte_order) ? mfalse : mtrue;
     // now that we have validated the header, we can read the header
     // but first map necessary pages
     if (merry_reader_alloc_pages(inp) != RET_SUCCESS)
         goto failed;
     // now we can read
-    if (merry_reader_read_inst(inp) != RET_SUCCESS || merry_reader_read_data(inp) != RET_SUCCESS)
+    if (merry_reader_load(inp) != RET_SUCCESS)
         goto failed;
     return inp;
 failed:
@@ -17,84 +17,139 @@ mret_t merry_requestHdlr_init(msize_t queue_len, MerryCond *cond)
         return RET_FAILURE;
     }
     req_hdlr.host_cond = cond;
-    req_hdlr.handle_more = mtrue;
+    atomic_init(&req_hdlr.handle_more, mtrue);
+    atomic_init(&req_hdlr.host_sleeping, mfalse);
+    atomic_init(&req_hdlr.panicking, mfalse);
+    req_hdlr.panic_taken = mfalse;
     // _log_(_REQHDLR_, "SUCCESS", "Request handler successfully initialized");
     return RET_SUCCESS;
 }
 
-mret_t merry_requestHdlr_push_request(msize_t req_id, msize_t id, MerryCond *req_cond)
+_MERRY_INTERNAL_ void merry_requestHdlr_wake_host()
 {
-    // _llog_(_REQHDLR_, "REQ_PUSH", "Core ID %lu pushing request %lu", id, req_id);
-    mret_t success = RET_SUCCESS; // just to tell the core to stop furthur execution
+    // The manager sets host_sleeping before it checks the queue one last time and we check it after publishing the request
+    // Both are seq_cst and so either the manager sees our request or we see that it is sleeping
+    if (atomic_load(&req_hdlr.host_sleeping) == mfalse)
+        return; // it will get to our request on its own
+    // taking the lock makes sure that the manager is actually waiting and not just about to
     merry_mutex_lock(req_hdlr.lock);
-    if (req_hdlr.handle_more == mfalse)
-        goto here; // don't accept more
-    if (merry_push_request(req_hdlr.queue, req_cond, req_id, id) == mfalse)
+    merry_cond_signal(req_hdlr.host_cond);
+    merry_mutex_unlock(req_hdlr.lock);
+}
+
+void merry_requestHdlr_await(MerryRequestCompletion *completion)
+{
+    // Most requests are done in no time and so spin for a bit before going to sleep
+    for (msize_t i = 0; i < _MERRY_REQUEST_SPIN_COUNT_; i++)
     {
-        // _llog_(_REQHDLR_, "PANIC", "Request handler panic in core ID %lu", id);
-        merry_panic_push(req_hdlr.queue, _PANIC_REQBUFFEROVERFLOW); // panic
-        if (req_hdlr.queue->data_count == 1)
-            merry_cond_signal(req_hdlr.host_cond); // wake up the OS
-        success = RET_FAILURE;
+        if (atomic_load_explicit(&completion->done, memory_order_acquire) == mtrue)
+            return;
     }
-    else
+    merry_mutex_lock(completion->lock);
+    while (atomic_load_explicit(&completion->done, memory_order_acquire) == mfalse)
+        merry_cond_wait(completion->cond, completion->lock); // the return value from the request should be in the requesting core's Registers
+    merry_mutex_unlock(completion->lock);
+}
+
+_MERRY_INTERNAL_ mret_t merry_requestHdlr_push(MerryOSRequest *request)
+{
+    // _llog_(_REQHDLR_, "REQ_PUSH", "Core ID %lu pushing request %lu", request->id, request->request_number);
+    if (atomic_load(&req_hdlr.handle_more) == mfalse)
+        return RET_FAILURE; // don't accept more
+    atomic_store_explicit(&request->completion->done, mfalse, memory_order_relaxed);
+    if (merry_push_request(req_hdlr.queue, request) == mfalse)
     {
-        // we succeeded
-        // now we wait for the request to be fulfilled
-        // _llog_(_REQHDLR_, "REQ_PUSH_SUCCESS", "Core ID %lu successfully pushed request", id);
-        if (req_hdlr.queue->data_count == 1)
-            merry_cond_signal(req_hdlr.host_cond); // wake up the OS
-        // _llog_(_REQHDLR_, "WAITING", "Core ID %lu waiting for request to be fulfilled", id);
-        merry_cond_wait(req_cond, req_hdlr.lock);  // the return value from the request should be in the requesting core's Registers
-        // _llog_(_REQHDLR_, "DONE", "Core ID %lu request fulfilled. Waking up now", id);
+        // _llog_(_REQHDLR_, "PANIC", "Request handler panic in core ID %lu", request->id);
+        merry_requestHdlr_panic(_PANIC_REQBUFFEROVERFLOW); // panic
+        return RET_FAILURE;
     }
-    goto here;
-here:
-    merry_mutex_unlock(req_hdlr.lock);
-    return success;
+    // we succeeded
+    // _llog_(_REQHDLR_, "REQ_PUSH_SUCCESS", "Core ID %lu successfully pushed request", request->id);
+    merry_requestHdlr_wake_host();
+    return RET_SUCCESS;
+}
+
+mret_t merry_requestHdlr_push_request(msize_t req_id, msize_t id, MerryRequestCompletion *completion, mqptr_t regs)
+{
+    MerryOSRequest request = {req_id, completion, id, regs, RET_NULL, RET_NULL};
+    if (merry_requestHdlr_push(&request) == RET_FAILURE)
+        return RET_FAILURE;
+    // now we wait for the request to be fulfilled
+    // _llog_(_REQHDLR_, "WAITING", "Core ID %lu waiting for request to be fulfilled", id);
+    merry_requestHdlr_await(completion);
+    // _llog_(_REQHDLR_, "DONE", "Core ID %lu request fulfilled. Waking up now", id);
+    return RET_SUCCESS;
+}
+
+mret_t merry_requestHdlr_push_async(msize_t req_id, msize_t id, MerryRequestCompletion *completion, mqptr_t regs, mqptr_t result)
+{
+    MerryOSRequest request = {req_id, completion, id, regs, result, RET_NULL};
+    return merry_requestHdlr_push(&request);
+}
+
+void merry_requestHdlr_complete(MerryOSRequest *request)
+{
+    MerryRequestCompletion *completion = request->completion;
+    if (completion == RET_NULL)
+        return; // panics have no one waiting for them
+    // the core might be checking done right before going to sleep and so done is set under its lock
+    merry_mutex_lock(completion->lock);
+    atomic_store_explicit(&completion->done, mtrue, memory_order_release);
+    merry_cond_signal(completion->cond);
+    merry_mutex_unlock(completion->lock);
+    // a core run by the scheduler isn't sleeping on the cond and so it has to be put back on a run queue instead
+    if (completion->wake != RET_NULL)
+        completion->wake(completion->waiter);
 }
 
 void merry_requestHdlr_kill_requests()
 {
     // _log_(_REQHDLR_, "PANIC", "Request Handler panicking; Killing requests");
-    merry_mutex_lock(req_hdlr.lock);
+    atomic_store(&req_hdlr.handle_more, mfalse);
     MerryOSRequest request;
-    for (msize_t i = 0; i < req_hdlr.queue->data_count; i++)
-    {
-        merry_pop_request(req_hdlr.queue, &request);
-        merry_cond_signal(request._wait_lock); // wake up the waiting core
-    }
-    merry_mutex_unlock(req_hdlr.lock);
+    while (merry_pop_request(req_hdlr.queue, &request) == mtrue)
+        merry_requestHdlr_complete(&request); // wake up the waiting core
 }
 
 void merry_requestHdlr_panic(merrot_t error)
 {
     // _log_(_REQHDLR_, "PANIC", "Panic push requested");
-    merry_mutex_lock(req_hdlr.lock);
-    if (req_hdlr.handle_more == mfalse)
-        goto here;                           // we are already panicking
-    merry_panic_push(req_hdlr.queue, error); // panic push
-    if (req_hdlr.queue->data_count == 1)
-        merry_cond_signal(req_hdlr.host_cond); // wake up the OS if sleeping
-    req_hdlr.handle_more = mfalse;             // don't accept any more requests
-    goto here;
-here:
-    merry_mutex_unlock(req_hdlr.lock);
+    mbool_t expected = mtrue;
+    if (atomic_compare_exchange_strong(&req_hdlr.handle_more, &expected, mfalse) == mfalse)
+        return; // we are already panicking(or exiting), don't accept any more requests
+    // the panic doesn't go through the queue so that it can't be lost when the queue is full
+    req_hdlr.panic_error = error;
+    atomic_store(&req_hdlr.panicking, mtrue); // only now can the manager see it
+    merry_requestHdlr_wake_host();            // wake up the OS if sleeping
 }
 
 mbool_t merry_requestHdlr_pop_request(MerryOSRequest *request)
 {
-    // even the OS can't do anything while some core is pushing
-    merry_mutex_lock(req_hdlr.lock);
     // in this case, failure would mean empty queue which ultimately tells the OS to go to sleep until a new request arrives
-    mret_t ret = mfalse;
-    // if (req_hdlr.handle_more == mfalse)
-    //     goto here; // we shouldn't provide for any request now since we are in a state of panic[The OS should never call this function once a state of panic is entered]
-    ret = merry_pop_request(req_hdlr.queue, request);
-    goto here;
-here:
+    // the panic always comes first
+    if (req_hdlr.panic_taken == mfalse && atomic_load(&req_hdlr.panicking) == mtrue)
+    {
+        req_hdlr.panic_taken = mtrue;
+        request->request_number = req_hdlr.panic_error;
+        request->completion = RET_NULL;
+        request->id = 0;
+        request->regs = RET_NULL;
+        request->result = RET_NULL;
+        request->file = RET_NULL;
+        return mtrue;
+    }
+    return merry_pop_request(req_hdlr.queue, request);
+}
+
+void merry_requestHdlr_wait()
+{
+    merry_mutex_lock(req_hdlr.lock);
+    atomic_store(&req_hdlr.host_sleeping, mtrue);
+    // check one last time since a core may have pushed before it could see that we are sleeping
+    if (merry_is_queue_emtpy(req_hdlr.queue) == mtrue && (req_hdlr.panic_taken == mtrue || atomic_load(&req_hdlr.panicking) == mfalse))
+        merry_cond_wait(req_hdlr.host_cond, req_hdlr.lock);
+    atomic_store(&req_hdlr.host_sleeping, mfalse);
     merry_mutex_unlock(req_hdlr.lock);
-    return ret;
 }
 
 void merry_requestHdlr_destroy()
@@ -102,4 +157,4 @@ void merry_requestHdlr_destroy()
     // _log_(_REQHDLR_, "DESTROYING", "Destroying request handler");
     merry_mutex_destroy(req_hdlr.lock);
     merry_request_queue_destroy(req_hdlr.queue);
-}
\ No newline at end of file
+}
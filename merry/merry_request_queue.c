@@ -2,45 +2,77 @@
 
 MerryRequestQueue *merry_request_queue_init(msize_t number_of_requests)
 {
-    MerryRequestQueue *queue;
-    _MERRY_QUEUE_INIT_(MerryRequestQueue, queue)
+    MerryRequestQueue *queue = (MerryRequestQueue *)aligned_alloc(_MERRY_CACHE_LINE_LEN_, sizeof(MerryRequestQueue));
     if (queue == NULL)
         return RET_NULL; // failed to initialize
-    mbool_t ret = mtrue;
-    _MERRY_QUEUE_CREATE_NODES_NOPTR_(queue, MerryRequestNode, number_of_requests, ret)
-    if (ret == mfalse)
+    // round the capacity up to a power of 2 so that positions can be masked instead of divided
+    msize_t capacity = 2;
+    while (capacity < number_of_requests)
+        capacity <<= 1;
+    queue->slots = (MerryRequestSlot *)aligned_alloc(_MERRY_CACHE_LINE_LEN_, sizeof(MerryRequestSlot) * capacity);
+    if (queue->slots == NULL)
     {
-        _MERRY_DESTROY_QUEUE_NOPTR_(queue)
+        free(queue);
         return RET_NULL;
     }
+    for (msize_t i = 0; i < capacity; i++)
+        atomic_init(&queue->slots[i].seq, i);
+    queue->mask = capacity - 1;
+    atomic_init(&queue->head, 0);
+    queue->tail = 0;
     return queue; // success
 }
 
-void merry_request_queue_destroy(MerryRequestQueue *queue){
+void merry_request_queue_destroy(MerryRequestQueue *queue)
+{
     // queue is most likely not NULL
-    _MERRY_DESTROY_QUEUE_NOPTR_(queue)
-    // that is all
+    free(queue->slots);
+    free(queue);
 }
 
-mbool_t merry_push_request(MerryRequestQueue *queue, MerryCond *_req_cond, msize_t req_num, msize_t id)
+mbool_t merry_is_queue_emtpy(MerryRequestQueue *queue)
 {
-    mbool_t ret = mtrue;
-    // create a new request
-    MerryOSRequest new_req = {req_num, _req_cond, id};
-    _MERRY_QUEUE_PUSH_NOPTR_(queue, new_req, ret)
-    return ret; // should be mfalse only when the queue is full
+    MerryRequestSlot *slot = &queue->slots[queue->tail & queue->mask];
+    // seq_cst since the manager uses this right after saying that it is going to sleep
+    return atomic_load_explicit(&slot->seq, memory_order_seq_cst) != queue->tail + 1 ? mtrue : mfalse;
 }
 
-mbool_t merry_pop_request(MerryRequestQueue *queue, MerryOSRequest *dest)
+mbool_t merry_push_request(MerryRequestQueue *queue, MerryOSRequest *request)
 {
-    mbool_t ret = mtrue;
-    _MERRY_QUEUE_POP_NOPTR_(queue, *dest, ret)
-    return ret; // should be mfalse only when the queue is empty
+    msize_t pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    MerryRequestSlot *slot;
+    while (mtrue)
+    {
+        slot = &queue->slots[pos & queue->mask];
+        msize_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        mqword_t diff = seq - pos;
+        if (diff == 0)
+        {
+            // the slot is free, claim the position
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+            // someone else got it and pos now has the new head
+        }
+        else if ((long long)diff < 0)
+            return mfalse; // the slot still has a request from the last lap and so the queue is full
+        else
+            pos = atomic_load_explicit(&queue->head, memory_order_relaxed); // someone pushed in between, try again
+    }
+    slot->request = *request;
+    // publish it to the manager
+    // seq_cst so that it cannot be reordered with the check for a sleeping manager that follows
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_seq_cst);
+    return mtrue;
 }
 
-void merry_panic_push(MerryRequestQueue *queue, merrot_t error)
+mbool_t merry_pop_request(MerryRequestQueue *queue, MerryOSRequest *dest)
 {
-    MerryOSRequest req = {error, NULL, 0};
-    _MERRY_QUEUE_PANIC_PUSH_NOPTR_(queue, req)
-    queue->data_count++;
-}
\ No newline at end of file
+    MerryRequestSlot *slot = &queue->slots[queue->tail & queue->mask];
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != queue->tail + 1)
+        return mfalse; // should be mfalse only when the queue is empty
+    *dest = slot->request;
+    // hand the slot back to the producers for the next lap
+    atomic_store_explicit(&slot->seq, queue->tail + queue->mask + 1, memory_order_release);
+    queue->tail++;
+    return mtrue;
+}
@@ -0,0 +1,237 @@
+#include "internals/merry_scheduler.h"
+
+_MERRY_INTERNAL_ void merry_sched_push(MerrySchedWorker *worker, MerryCore *core)
+{
+    MerryScheduler *sched = worker->sched;
+    merry_mutex_lock(worker->lock);
+    worker->queue[(worker->head + worker->count) % sched->queue_len] = core;
+    worker->count++;
+    merry_mutex_unlock(worker->lock);
+    // the sleepers count themselves before they check ready and we check them after counting the core
+    // Both are seq_cst and so either they see the core or we see them
+    atomic_fetch_add(&sched->ready, 1);
+    if (atomic_load(&sched->sleeping) == 0)
+        return;
+    merry_mutex_lock(sched->lock);
+    merry_cond_signal(sched->cond);
+    merry_mutex_unlock(sched->lock);
+}
+
+_MERRY_INTERNAL_ MerryCore *merry_sched_take(MerrySchedWorker *worker, mbool_t steal)
+{
+    // the worker takes the core that waited the longest while a thief takes the one that was pushed last
+    MerryCore *core = RET_NULL;
+    merry_mutex_lock(worker->lock);
+    if (worker->count > 0)
+    {
+        if (steal == mtrue)
+            core = worker->queue[(worker->head + worker->count - 1) % worker->sched->queue_len];
+        else
+        {
+            core = worker->queue[worker->head];
+            worker->head = (worker->head + 1) % worker->sched->queue_len;
+        }
+        worker->count--;
+    }
+    merry_mutex_unlock(worker->lock);
+    if (core != RET_NULL)
+        atomic_fetch_sub(&worker->sched->ready, 1);
+    return core;
+}
+
+_MERRY_INTERNAL_ MerryCore *merry_sched_next(MerrySchedWorker *worker)
+{
+    MerryScheduler *sched = worker->sched;
+    MerryCore *core = merry_sched_take(worker, mfalse);
+    if (core != RET_NULL)
+        return core;
+    if (atomic_load(&sched->ready) == 0)
+        return RET_NULL; // nothing to steal either
+    for (msize_t i = 1; i < sched->worker_count; i++)
+    {
+        if ((core = merry_sched_take(&sched->workers[(worker->id + i) % sched->worker_count], mtrue)) != RET_NULL)
+            return core;
+    }
+    return RET_NULL;
+}
+
+_MERRY_INTERNAL_ void merry_sched_wake(mptr_t arg)
+{
+    // called by whoever fulfilled one of the core's requests
+    // The core is only parked on one of them and so this may be for another one but the worker checks that before running it
+    MerryCore *core = (MerryCore *)arg;
+    mbyte_t expected = _MERRY_CORE_PARKED_;
+    atomic_thread_fence(memory_order_seq_cst); // done was set before this and the worker checks it after parking the core
+    if (atomic_compare_exchange_strong(&core->run_state, &expected, _MERRY_CORE_READY_) == mfalse)
+        return; // it is still running(and will see that the request is done) or someone else woke it up already
+    MerryScheduler *sched = (MerryScheduler *)core->sched;
+    merry_sched_push(&sched->workers[core->worker], core);
+}
+
+_MERRY_INTERNAL_ void merry_sched_park(MerryCore *core)
+{
+    atomic_store(&core->run_state, _MERRY_CORE_PARKED_);
+    // the request may have been done before the core was parked and then nobody would ever wake it up
+    if (atomic_load(&core->blocked_on->done) == mtrue)
+        merry_sched_wake(core);
+}
+
+_MERRY_INTERNAL_ void merry_sched_run(MerrySchedWorker *worker, MerryCore *core)
+{
+    core->worker = worker->id;
+    if (core->blocked_on != RET_NULL)
+    {
+        if (atomic_load(&core->blocked_on->done) == mfalse)
+        {
+            // woken up by one of its other requests
+            merry_sched_park(core);
+            return;
+        }
+        core->blocked_on = RET_NULL;
+    }
+    atomic_store(&core->run_state, _MERRY_CORE_RUNNING_);
+    switch (merry_core_run(core, _MERRY_SCHED_QUANTUM_))
+    {
+    case _MERRY_CORE_PREEMPTED_:
+        atomic_store(&core->run_state, _MERRY_CORE_READY_);
+        merry_sched_push(worker, core);
+        break;
+    case _MERRY_CORE_BLOCKED_:
+        merry_sched_park(core);
+        break;
+    default:
+        merry_out_flush(&core->out); // whatever is left
+        atomic_store(&core->run_state, _MERRY_CORE_DONE_);
+        worker->sched->done(core);
+    }
+}
+
+_MERRY_INTERNAL_ _THRET_T_ merry_sched_work(mptr_t arg)
+{
+    MerrySchedWorker *worker = (MerrySchedWorker *)arg;
+    MerryScheduler *sched = worker->sched;
+    while (atomic_load(&sched->stop) == mfalse)
+    {
+        MerryCore *core = merry_sched_next(worker);
+        if (core != RET_NULL)
+        {
+            merry_sched_run(worker, core);
+            continue;
+        }
+        // nothing to run anywhere and so we sleep until a core is pushed
+        merry_mutex_lock(sched->lock);
+        atomic_fetch_add(&sched->sleeping, 1);
+        while (atomic_load(&sched->ready) == 0 && atomic_load(&sched->stop) == mfalse)
+            merry_cond_wait(sched->cond, sched->lock);
+        atomic_fetch_sub(&sched->sleeping, 1);
+        merry_mutex_unlock(sched->lock);
+    }
+#if defined(_MERRY_HOST_OS_LINUX_)
+    return RET_NULL;
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+    return 0;
+#endif
+}
+
+MerryScheduler *merry_sched_init(msize_t worker_count, msize_t queue_len, merry_sched_done_t done)
+{
+    MerryScheduler *sched = (MerryScheduler *)calloc(1, sizeof(MerryScheduler));
+    if (sched == NULL)
+        return RET_NULL;
+    sched->queue_len = queue_len;
+    sched->done = done;
+    atomic_init(&sched->ready, 0);
+    atomic_init(&sched->sleeping, 0);
+    atomic_init(&sched->stop, mfalse);
+    if ((sched->lock = merry_mutex_init()) == RET_NULL || (sched->cond = merry_cond_init()) == RET_NULL)
+        goto failure;
+    if ((sched->workers = (MerrySchedWorker *)calloc(worker_count, sizeof(MerrySchedWorker))) == NULL)
+        goto failure;
+    // the queues are made before any worker starts as the workers steal from each other
+    for (msize_t i = 0; i < worker_count; i++)
+    {
+        MerrySchedWorker *worker = &sched->workers[i];
+        worker->id = i;
+        worker->sched = sched;
+        if ((worker->lock = merry_mutex_init()) == RET_NULL || (worker->queue = (MerryCore **)calloc(queue_len, sizeof(MerryCore *))) == NULL || (worker->thread = merry_thread_init()) == RET_NULL)
+        {
+            sched->worker_count = i + 1;
+            goto failure;
+        }
+    }
+    sched->worker_count = worker_count;
+    for (msize_t i = 0; i < worker_count; i++)
+    {
+        if (merry_create_thread(sched->workers[i].thread, &merry_sched_work, &sched->workers[i]) == RET_FAILURE)
+        {
+            // the ones that did start must be stopped before anything is freed
+            for (msize_t j = i; j < worker_count; j++)
+            {
+                merry_thread_destroy(sched->workers[j].thread);
+                sched->workers[j].thread = RET_NULL;
+            }
+            merry_sched_stop(sched);
+            merry_sched_destroy(sched);
+            return RET_NULL;
+        }
+    }
+    return sched;
+failure:
+    merry_sched_destroy(sched);
+    return RET_NULL;
+}
+
+void merry_sched_add(MerryScheduler *sched, MerryCore *core)
+{
+    // from now on the core's requests put it back on a queue instead of signaling its cond
+    core->sched = sched;
+    core->completion.wake = &merry_sched_wake;
+    core->completion.waiter = core;
+    for (msize_t i = 0; i < _MERRY_ASYNC_SLOTS_; i++)
+    {
+        core->async[i].completion.wake = &merry_sched_wake;
+        core->async[i].completion.waiter = core;
+    }
+    core->blocked_on = RET_NULL;
+    core->worker = core->core_id % sched->worker_count; // spread the new cores; stealing takes care of the rest
+    atomic_store(&core->run_state, _MERRY_CORE_READY_);
+    merry_sched_push(&sched->workers[core->worker], core);
+}
+
+void merry_sched_abandon(MerryScheduler *sched, msize_t worker)
+{
+    sched->workers[worker].abandoned = mtrue;
+}
+
+void merry_sched_stop(MerryScheduler *sched)
+{
+    if (sched == NULL)
+        return;
+    atomic_store(&sched->stop, mtrue);
+    merry_mutex_lock(sched->lock);
+    merry_cond_broadcast(sched->cond);
+    merry_mutex_unlock(sched->lock);
+    // a worker finishes its core's quantum first which is never long as the cores were stopped and can't block in the host anymore
+    // The ones that were blocked there already are left to exit on their own if they ever come back
+    for (msize_t i = 0; i < sched->worker_count; i++)
+    {
+        if (sched->workers[i].thread != RET_NULL && sched->workers[i].abandoned == mfalse)
+            merry_thread_join(sched->workers[i].thread, NULL);
+    }
+}
+
+void merry_sched_destroy(MerryScheduler *sched)
+{
+    if (sched == NULL)
+        return;
+    for (msize_t i = 0; i < sched->worker_count; i++)
+    {
+        merry_mutex_destroy(sched->workers[i].lock);
+        merry_thread_destroy(sched->workers[i].thread);
+        free(sched->workers[i].queue);
+    }
+    free(sched->workers);
+    merry_mutex_destroy(sched->lock);
+    merry_cond_destroy(sched->cond);
+    free(sched);
+}
@@ -0,0 +1,121 @@
+#include "internals/merry_thread_pool.h"
+
+_MERRY_INTERNAL_ _THRET_T_ merry_thPool_exec_func(mptr_t thread)
+{
+    MerryThreadPoolThread *th = (MerryThreadPoolThread *)thread;
+    MerryOSRequest request;
+    // now this thread will run
+    while (mtrue)
+    {
+        if (merry_pop_request(th->queue, &request) == mtrue)
+        {
+            th->exec(&request);
+            continue;
+        }
+        // the queue is only checked for stop once it is empty so that no core is left waiting
+        if (atomic_load(&th->stop) == mtrue)
+            break;
+        // wait until we are assigned a job
+        // this works the same way as the manager's sleeping in the request handler
+        merry_mutex_lock(th->lock);
+        atomic_store(&th->sleeping, mtrue);
+        if (merry_is_queue_emtpy(th->queue) == mtrue && atomic_load(&th->stop) == mfalse)
+            merry_cond_wait(th->cond, th->lock);
+        atomic_store(&th->sleeping, mfalse);
+        merry_mutex_unlock(th->lock);
+    }
+#if defined(_MERRY_HOST_OS_LINUX_)
+    return RET_NULL;
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+    return 0;
+#endif
+}
+
+_MERRY_INTERNAL_ void merry_thPool_wake_thread(MerryThreadPoolThread *th)
+{
+    if (atomic_load(&th->sleeping) == mfalse)
+        return;
+    merry_mutex_lock(th->lock);
+    merry_cond_signal(th->cond);
+    merry_mutex_unlock(th->lock);
+}
+
+_MERRY_INTERNAL_ mret_t merry_thPool_start_thread(MerryThreadPool *pool, msize_t id, msize_t queue_len, merry_thPool_exec_t exec)
+{
+    MerryThreadPoolThread *th = &pool->threads[id];
+    th->exec = exec;
+    atomic_init(&th->sleeping, mfalse);
+    atomic_init(&th->stop, mfalse);
+    if ((th->queue = merry_request_queue_init(queue_len)) == RET_NULL)
+        return RET_FAILURE;
+    if ((th->lock = merry_mutex_init()) == RET_NULL)
+        return RET_FAILURE;
+    if ((th->cond = merry_cond_init()) == RET_NULL)
+        return RET_FAILURE;
+    if ((th->thread = merry_thread_init()) == RET_NULL)
+        return RET_FAILURE;
+    if (merry_create_thread(th->thread, &merry_thPool_exec_func, th) == RET_FAILURE)
+        return RET_FAILURE;
+    th->_is_init = mtrue;
+    return RET_SUCCESS;
+}
+
+MerryThreadPool *merry_init_thread_pool(msize_t pool_size, msize_t queue_len, merry_thPool_exec_t exec)
+{
+    MerryThreadPool *pool = (MerryThreadPool *)malloc(sizeof(MerryThreadPool));
+    if (pool == NULL)
+        return RET_NULL;
+    // calloc so that destroying a half initialized pool is safe
+    pool->threads = (MerryThreadPoolThread *)calloc(pool_size, sizeof(MerryThreadPoolThread));
+    if (pool->threads == NULL)
+    {
+        free(pool);
+        return RET_NULL;
+    }
+    pool->pool_size = pool_size;
+    for (msize_t i = 0; i < pool_size; i++)
+    {
+        if (merry_thPool_start_thread(pool, i, queue_len, exec) == RET_FAILURE)
+        {
+            merry_destroy_thread_pool(pool);
+            return RET_NULL;
+        }
+    }
+    return pool;
+}
+
+mret_t merry_thPool_assign(MerryThreadPool *pool, msize_t key, MerryOSRequest *request)
+{
+    // assign the thread that the key belongs to a new task
+    MerryThreadPoolThread *th = &pool->threads[key % pool->pool_size];
+    if (merry_push_request(th->queue, request) == mfalse)
+        return RET_FAILURE; // the caller should fulfill it itself
+    merry_thPool_wake_thread(th);
+    return RET_SUCCESS;
+}
+
+void merry_destroy_thread_pool(MerryThreadPool *pool)
+{
+    if (pool == NULL)
+        return;
+    // we have to stop every thread as well
+    for (msize_t i = 0; i < pool->pool_size; i++)
+    {
+        MerryThreadPoolThread *th = &pool->threads[i];
+        if (th->_is_init == mtrue)
+        {
+            atomic_store(&th->stop, mtrue);
+            merry_mutex_lock(th->lock);
+            merry_cond_signal(th->cond);
+            merry_mutex_unlock(th->lock);
+            merry_thread_join(th->thread, NULL);
+        }
+        merry_thread_destroy(th->thread);
+        if (th->queue != NULL)
+            merry_request_queue_destroy(th->queue);
+        merry_mutex_destroy(th->lock);
+        merry_cond_destroy(th->cond);
+    }
+    free(pool->threads);
+    free(pool);
+}
@@ -4,6 +4,8 @@
 #include "../utils/merry_types.h"
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <stdatomic.h>
 
 #if defined(_MERRY_HOST_OS_LINUX_)
 #define _USE_LINUX_
@@ -14,7 +16,23 @@
 #endif
 
 typedef struct MerryDynEntry MerryDynEntry;
+typedef struct MerryDynSlot MerryDynSlot;
+typedef struct MerryDynSig MerryDynSig;
 typedef struct MerryDynLoader MerryDynLoader;
+typedef struct MerryDynClosing MerryDynClosing;
+typedef struct MerryDynRetired MerryDynRetired;
+
+#define _MERRY_DYN_SLOTS_ 256 // the most functions that can be bound at once
+
+// Typed calls
+// The arguments are handed to the function in the host's registers and so only as many as fit there can be passed
+// With the System V ABI, integers and floating point numbers go in different registers and so one call shim can take any mix of them
+#if defined(_MERRY_HOST_OS_LINUX_) && defined(_MERRY_HOST_CPU_x86_64_ARCH_)
+#define _MERRY_DYN_TYPED_CALLS_ 1
+#endif
+#define _MERRY_DYN_INT_ARGS_ 6                                      // integers and pointers
+#define _MERRY_DYN_FP_ARGS_ 8                                       // floats and doubles
+#define _MERRY_DYN_MAX_ARGS_ (_MERRY_DYN_INT_ARGS_ + _MERRY_DYN_FP_ARGS_)
 
 _MERRY_DEFINE_FUNC_PTR_(mdword_t, dynfunc_t, mptr_t ptr)
 
@@ -29,25 +47,120 @@ struct MerryDynEntry
     mbool_t handle_open; // is the library open to use?
 };
 
+// The types are: b, h, i, l for signed 8, 16, 32 and 64-bit integers and B, H, I, L for the unsigned ones, f for float, d for double,
+// p for a pointer into the data memory(only as an argument) and v for nothing(only as the return type)
+// p may be followed by the number of bytes that the function uses there
+struct MerryDynSig
+{
+    mbool_t typed;      // if not, the function is a dynfunc_t
+    mbool_t from_block; // the arguments are qwords at the address in Mc instead of the registers from Mc onwards
+    char ret;
+    char args[_MERRY_DYN_MAX_ARGS_];
+    msize_t lens[_MERRY_DYN_MAX_ARGS_]; // for every p, its number of bytes or 0 if it wasn't given
+    msize_t argc;
+};
+
+// a function that has already been looked up
+// the program gets the slot's index and calls through it without the name ever being read or looked up again
+struct MerryDynSlot
+{
+    dynfunc_t func; // NULL if the slot is free
+    msize_t handle; // the library it belongs to
+    mqword_t hash;  // of the name so that most names don't need to be compared
+    mstr_t name;
+    mbool_t bound;  // the program knows the slot; if not, it only caches a DYNCALL by name and may be taken for a bind
+    mbool_t thread_safe;
+    _Atomic(dynfunc_t) direct; // func if the program said it is thread safe and there is no timeout; the cores read this without going through the Manager
+    _Atomic msize_t calls;     // the calls into the slot's function that the Manager isn't making itself and are still running
+    msize_t timeout;           // in milliseconds; if not 0, the function is called by the call pool and given up on after this long
+    _Atomic(MerryDynSig *) sig; // replaced as a whole so that a core calling the function sees either the old or the new one
+};
+
+// a library that was unloaded while its functions were still being called
+// It is closed once every slot that it had is done with its calls
+struct MerryDynClosing
+{
+#if defined(_USE_LINUX_)
+    mptr_t lib_handle;
+#elif defined(_USE_WIN_)
+    HINSTANCE lib_handle;
+#endif
+    mbool_t slots[_MERRY_DYN_SLOTS_];
+    MerryDynClosing *next;
+};
+
+// a signature that was replaced while the slot's function was being called with it
+struct MerryDynRetired
+{
+    MerryDynSig *sig;
+    msize_t slot;
+    MerryDynRetired *next;
+};
+
 struct MerryDynLoader
 {
     MerryDynEntry *entries; // the entries
     msize_t entry_count;    // number of entries
     msize_t closed_entry_count;
+    MerryDynSlot slots[_MERRY_DYN_SLOTS_];
+    MerryDynClosing *closing;
+    MerryDynRetired *retired;
 };
 
 static MerryDynLoader loader;
 
 mbool_t merry_loader_init(msize_t initial_entry_count);
 
+// the libraries that are still being called are left open
 void merry_loader_close();
 
 mbool_t merry_loader_loadLib(mstr_t lib_path, msize_t *handle);
 
+// the library's functions can't be called anymore once this returns but it is only closed once the calls that are already running return
 void merry_loader_unloadLib(msize_t handle);
 
 // each function in the library must return unsigned int which will be the return value
 // the return value of the function is loaded into the Ma register
 dynfunc_t merry_loader_getFuncSymbol(msize_t handle, mstr_t sym_name);
 
+// look up the function once and give it a slot; binding the same function again gives the same slot
+// fails if there is no such function or every slot is taken
+// Unloading the library frees the slots of its functions
+// thread_safe says that the function may be called by many cores at once on their own threads
+mbool_t merry_loader_bind(msize_t handle, mstr_t sym_name, mbool_t thread_safe, msize_t *slot);
+
+// NULL if nothing is bound to the slot
+dynfunc_t merry_loader_get_slot(msize_t slot);
+
+// start calling the function in the slot without the Manager: the function if it was bound as thread safe and NULL otherwise
+// Unless it is NULL, the call must end with merry_loader_leave and the library stays loaded until then
+// Unlike everything else here, these may be called from any thread at any time
+dynfunc_t merry_loader_enter(msize_t slot);
+void merry_loader_leave(msize_t slot);
+
+// the same as merry_loader_enter but for a call that the Manager makes and that may outlive the request(one with a timeout)
+void merry_loader_hold(msize_t slot);
+
+// give the function in the slot a signature which is [*]<return type><argument types...> where * means the arguments are in a block
+// fails if it is malformed, has too many arguments of a kind or the host can't make typed calls
+mbool_t merry_loader_set_sig(msize_t slot, mstr_t desc);
+
+// the signature of a slot that has a function
+// A core calling the slot directly must only use it between merry_loader_enter and merry_loader_leave
+MerryDynSig *merry_loader_get_sig(msize_t slot);
+
+// call the function with the arguments as qwords(pointers already turned into host pointers) and return the result's bits
+mqword_t merry_loader_call_typed(dynfunc_t func, MerryDynSig *sig, mqptr_t args);
+
+// the same as merry_loader_getFuncSymbol but it remembers the function in a slot if there is one free
+// slot is the slot that the function is in or _MERRY_DYN_SLOTS_ if it couldn't be remembered
+dynfunc_t merry_loader_resolve(msize_t handle, mstr_t sym_name, msize_t *slot);
+
+// give the function in the slot a timeout in milliseconds(0 for none); fails if nothing is bound to the slot
+// A function with a timeout is never called directly by the cores even if it is thread safe
+mbool_t merry_loader_set_timeout(msize_t slot, msize_t timeout);
+
+// the timeout of the function in the slot(0 for none or if there is no such slot)
+msize_t merry_loader_get_timeout(msize_t slot);
+
 #endif
\ No newline at end of file
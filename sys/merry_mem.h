@@ -32,6 +32,7 @@
 
 #include <sys/mman.h> // for mmap
 #include <unistd.h>   // for sbrk
+#include <sys/uio.h>  // for iovec
 // we use mapping for mostly memory allocation and not for mapping any actual file
 // hence we simply need these protection flags and nothing else
 // but for future simplicity
@@ -42,6 +43,12 @@
 #define _MERRY_PROT_DEFAULT_ 0x00        // default protection flag
 #define _MERRY_FLAG_DEFAULT_ 0x00        // default flag
 
+// for mapping files right over memory that we already have
+#define _MERRY_MEM_FILE_MAP_SUPPORT_ 1
+#define _MERRY_MEM_HOST_PAGE_SIZE_ ((msize_t)sysconf(_SC_PAGESIZE))
+#define _MERRY_MEM_MAP_FILE_FIXED_(addr, size, fd, offset) mmap(addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, offset)
+#define _MERRY_MEM_MAP_ZERO_FIXED_(addr, size) mmap(addr, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED, -1, 0)
+
 // for extending system break point
 // some systems do not provide such functionality(Or Maybe I am just not knowledgeable)
 #define _MERRY_MEM_BRK_SUPPORT_ 1                     // meddling with the program's break point is supported
@@ -67,6 +74,16 @@
 // Default flag (not used in Windows)
 #define _MERRY_FLAG_DEFAULT_
 
+// Mapping a file over memory that we already have isn't supported
+#define _MERRY_MEM_FILE_MAP_SUPPORT_ 0
+
+// Windows has no iovec and so we have our own
+struct MerryIOVec
+{
+    void *iov_base;
+    size_t iov_len;
+};
+
 // No support for extending system break point in Windows
 #define _MERRY_MEM_BRK_SUPPORT_ 0
 #define _MERRY_MEM_GET_CURRENT_BRK_POINT_ NULL
@@ -75,6 +92,13 @@
 
 #endif
 
+// one buffer of a scatter/gather operation; on POSIX hosts it is the host's own so that it can be given to the host as it is
+#if defined(_MERRY_HOST_OS_LINUX_)
+typedef struct iovec MerryIOVec;
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+typedef struct MerryIOVec MerryIOVec;
+#endif
+
 #endif
 
 // this process can be cumbersome in Windows or similar systems where they refuse to provide the size of the memory we want but instead provide memory that is way
@@ -64,6 +64,8 @@ void merry_mutex_lock(MerryMutex *mutex);
 void merry_mutex_unlock(MerryMutex *mutex);
 // condition wait
 void merry_cond_wait(MerryCond *cond, MerryMutex *lock);
+// condition wait for at most ms milliseconds
+void merry_cond_timedwait(MerryCond *cond, MerryMutex *lock, msize_t ms);
 // condition signal
 void merry_cond_signal(MerryCond *cond);
 // broadcast signal
@@ -74,5 +76,7 @@ mret_t merry_create_detached_thread(MerryThread *thread, ThreadExecFunc func, vo
 mret_t merry_create_thread(MerryThread *thread, ThreadExecFunc func, void *arg);
 // join thread with the calling thread
 mret_t merry_thread_join(MerryThread *thread, void *return_val);
+// end the calling thread right here
+void merry_thread_exit();
 
 #endif
\ No newline at end of file
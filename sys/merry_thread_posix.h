@@ -26,6 +26,7 @@
 #define _MERRY_THREADABS_POSIX_
 
 #include <pthread.h> // this is assuming that the host system is unix-based posix compliant system
+#include <time.h>
 
 /*Mutex*/
 struct MerryMutex
@@ -0,0 +1,85 @@
+/*
+ * Host topology for the Merry VM
+ * MIT License
+ *
+ * Copyright (c) 2024 MegrajChauhan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _MERRY_TOPOLOGY_
+#define _MERRY_TOPOLOGY_
+
+// The host's CPUs and NUMA nodes and the ways to keep threads and memory on them
+// On Linux the nodes are read from sysfs and memory is placed with the raw mbind syscall(no libnuma)
+// On hosts where we can't tell, there is just one node with every CPU on it and placing memory does nothing
+
+#include "../utils/merry_config.h"
+#include "../utils/merry_types.h"
+#include "merry_thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MERRY_HOST_OS_LINUX_)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+#include <windows.h>
+#endif
+
+#define _MERRY_MAX_CPUS_ 1024 // the most CPUs that we know about
+#define _MERRY_MAX_NODES_ 64  // the most NUMA nodes that we know about
+
+typedef struct MerryTopology MerryTopology;
+
+struct MerryTopology
+{
+    msize_t cpu_count;                 // the CPUs are numbered from 0 to this
+    msize_t node_count;                // the nodes are numbered from 0 to this; 1 if the host has no NUMA
+    mbyte_t node_of[_MERRY_MAX_CPUS_]; // the node that every CPU is on
+};
+
+mret_t merry_topology_detect(MerryTopology *topo);
+
+// parse a list of CPUs such as "0-3,8,10-11" into cpus; fails if it is malformed, too long or has a CPU that the host doesn't have
+mret_t merry_topology_parse_cpus(MerryTopology *topo, mcstr_t list, msize_t *cpus, msize_t max, msize_t *count);
+
+// the CPUs on the node; returns how many
+msize_t merry_topology_node_cpus(MerryTopology *topo, msize_t node, msize_t *cpus, msize_t max);
+
+// print the list of CPUs as ranges(the way parse reads them)
+void merry_topology_print_cpus(FILE *stream, msize_t *cpus, msize_t count);
+
+// let the thread run only on the given CPUs
+mret_t merry_topology_pin(MerryThread *thread, msize_t *cpus, msize_t count);
+
+// start a detached thread that runs only on the given CPUs from its very first instruction
+// Unlike pinning it afterwards, nothing that the thread touches first ends up on another node
+mret_t merry_topology_start_pinned(MerryThread *thread, ThreadExecFunc func, mptr_t arg, msize_t *cpus, msize_t count);
+
+// put the pages of the range on the node from now on; the ones that were already touched are moved there
+// The range must be aligned to the host's pages
+mret_t merry_topology_bind(MerryTopology *topo, mptr_t addr, msize_t len, msize_t node);
+
+// the same but spread the pages over every node
+mret_t merry_topology_interleave(MerryTopology *topo, mptr_t addr, msize_t len);
+
+#endif
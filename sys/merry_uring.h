@@ -0,0 +1,104 @@
+/*
+ * io_uring wrapper for the Merry VM
+ * MIT License
+ *
+ * Copyright (c) 2024 MegrajChauhan
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _MERRY_URING_
+#define _MERRY_URING_
+
+// A very thin io_uring wrapper that talks to the kernel with the raw syscalls(no liburing)
+// Only one thread may prepare and submit entries while only one other thread may reap the completions
+// On hosts that don't have io_uring, merry_uring_init always fails and the users should fall back to something else
+
+#include "../utils/merry_config.h"
+#include "../utils/merry_types.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MERRY_HOST_OS_LINUX_)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdatomic.h>
+#endif
+
+typedef struct MerryURing MerryURing;
+
+enum
+{
+    _MERRY_URING_NOP_,
+    _MERRY_URING_READ_,
+    _MERRY_URING_WRITE_,
+    _MERRY_URING_READV_,  // buf is an array of iovecs and len is how many
+    _MERRY_URING_WRITEV_,
+};
+
+#if defined(_MERRY_HOST_OS_LINUX_)
+struct MerryURing
+{
+    int fd;            // the ring's file descriptor
+    mptr_t rings;      // the submission and the completion rings share one mapping
+    msize_t rings_len; // the length of that mapping
+    struct io_uring_sqe *sqes;
+    msize_t sqes_len;
+    // the submission ring
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_array;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    // the completion ring
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    struct io_uring_cqe *cqes;
+    unsigned cq_mask;
+    unsigned to_submit; // entries prepared but not yet given to the kernel
+};
+#else
+struct MerryURing
+{
+    unsigned to_submit;
+};
+#endif
+
+// entries is the most entries that may be prepared before submitting
+MerryURing *merry_uring_init(msize_t entries);
+
+// prepare an entry; this fails when the submission ring is full and so the caller should submit and try again
+// the result of the operation comes back with user_data
+mret_t merry_uring_prep(MerryURing *ring, mbyte_t op, int fd, mptr_t buf, msize_t len, mqword_t offset, mqword_t user_data);
+
+// give everything prepared so far to the kernel in one go
+// On failure, the entries that the kernel didn't take are still prepared
+mret_t merry_uring_submit(MerryURing *ring);
+
+// take back the last entry that was prepared but not submitted yet; fails if there is none
+mret_t merry_uring_unprep(MerryURing *ring, mqptr_t user_data);
+
+// wait for one completion; res is what the operation returned(negative errno on failure)
+mret_t merry_uring_wait(MerryURing *ring, mqptr_t user_data, msqword_t *res);
+
+void merry_uring_destroy(MerryURing *ring);
+
+#endif
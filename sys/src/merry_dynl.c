@@ -1,5 +1,8 @@
 #include "../merry_dynl.h"
 
+// the signature of every slot that wasn't given one
+_MERRY_INTERNAL_ MerryDynSig untyped = {.typed = mfalse};
+
 mbool_t merry_loader_init(msize_t initial_entry_count)
 {
     loader.entries = (MerryDynEntry *)malloc(sizeof(MerryDynEntry) * initial_entry_count);
@@ -11,29 +14,108 @@ mbool_t merry_loader_init(msize_t initial_entry_count)
     {
         loader.entries[i].handle_open = mtrue;
     }
+    for (msize_t i = 0; i < _MERRY_DYN_SLOTS_; i++)
+    {
+        loader.slots[i].func = RET_NULL;
+        loader.slots[i].name = NULL;
+        loader.slots[i].bound = mfalse;
+        loader.slots[i].thread_safe = mfalse;
+        loader.slots[i].timeout = 0;
+        atomic_init(&loader.slots[i].direct, RET_NULL);
+        atomic_init(&loader.slots[i].calls, 0);
+        atomic_init(&loader.slots[i].sig, &untyped);
+    }
+    loader.closing = NULL;
+    loader.retired = NULL;
     return mtrue;
 }
 
-void merry_loader_close()
+_MERRY_INTERNAL_ void merry_loader_reap()
 {
-    // all the open library handles must be closed
-    // but for safety purposes, we will check
-    if (loader.closed_entry_count != loader.entry_count)
+    // close the unloaded libraries that nothing is calling into anymore
+    MerryDynClosing **prev = &loader.closing;
+    while (*prev != NULL)
     {
-        for (msize_t i = 0; i < loader.entry_count; i++)
+        MerryDynClosing *closing = *prev;
+        mbool_t busy = mfalse;
+        for (msize_t i = 0; i < _MERRY_DYN_SLOTS_ && busy == mfalse; i++)
+            busy = closing->slots[i] == mtrue && atomic_load(&loader.slots[i].calls) != 0;
+        if (busy == mtrue)
         {
-            if (loader.entries[i].handle_open == mfalse)
-            {
+            prev = &closing->next;
+            continue;
+        }
 #if defined(_USE_LINUX_)
-                dlclose(loader.entries[i].lib_handle);
+        dlclose(closing->lib_handle);
 #elif defined(_USE_WIN_)
-                FreeLibrary(loader.entries[i].lib_handle);
+        FreeLibrary(closing->lib_handle);
 #endif
-            }
+        *prev = closing->next;
+        free(closing);
+    }
+    // the same for the signatures
+    MerryDynRetired **next = &loader.retired;
+    while (*next != NULL)
+    {
+        MerryDynRetired *retired = *next;
+        if (atomic_load(&loader.slots[retired->slot].calls) != 0)
+        {
+            next = &retired->next;
+            continue;
         }
+        *next = retired->next;
+        free(retired->sig);
+        free(retired);
+    }
+}
+
+_MERRY_INTERNAL_ void merry_loader_swap_sig(msize_t slot, MerryDynSig *sig)
+{
+    MerryDynSig *old = atomic_exchange(&loader.slots[slot].sig, sig);
+    if (old == &untyped)
+        return;
+    // seq_cst as in merry_loader_enter: a call that started after the exchange can only see the new one
+    if (atomic_load(&loader.slots[slot].calls) == 0)
+    {
+        free(old);
+        return;
+    }
+    MerryDynRetired *retired = (MerryDynRetired *)malloc(sizeof(MerryDynRetired));
+    if (retired == NULL)
+        return; // it is leaked as we can't know when it won't be used anymore
+    retired->sig = old;
+    retired->slot = slot;
+    retired->next = loader.retired;
+    loader.retired = retired;
+}
+
+void merry_loader_close()
+{
+    // all the open library handles must be closed
+    // but for safety purposes, we will check
+    if (loader.closed_entry_count != loader.entry_count)
+    {
+        for (msize_t i = 0; i < loader.entry_count; i++)
+            merry_loader_unloadLib(i);
+    }
+    merry_loader_reap();
+    // whatever is left is still being called(by a call that was given up on for eg) and so it stays loaded until the VM exits
+    while (loader.closing != NULL)
+    {
+        MerryDynClosing *next = loader.closing->next;
+        free(loader.closing);
+        loader.closing = next;
+    }
+    while (loader.retired != NULL)
+    {
+        MerryDynRetired *next = loader.retired->next;
+        free(loader.retired);
+        loader.retired = next;
     }
     if (loader.entries != NULL)
         free(loader.entries);
+    for (msize_t i = 0; i < _MERRY_DYN_SLOTS_; i++)
+        free(loader.slots[i].name);
 }
 
 _MERRY_INTERNAL_ msize_t merry_loader_find_free_handle()
@@ -71,6 +153,7 @@ _MERRY_INTERNAL_ msize_t merry_loader_check_entry(mstr_t path)
 
 mbool_t merry_loader_loadLib(mstr_t lib_path, msize_t *handle)
 {
+    merry_loader_reap();
     if ((*handle = merry_loader_check_entry(lib_path)) < loader.entry_count)
     {
         return mtrue;
@@ -103,26 +186,64 @@ mbool_t merry_loader_loadLib(mstr_t lib_path, msize_t *handle)
     return mtrue; // the library is loaded
 }
 
+_MERRY_INTERNAL_ void merry_loader_free_slot(msize_t slot)
+{
+    atomic_store(&loader.slots[slot].direct, RET_NULL); // seq_cst as the unload looks at the calls right after
+    loader.slots[slot].func = RET_NULL;
+    free(loader.slots[slot].name);
+    loader.slots[slot].name = NULL;
+    loader.slots[slot].bound = mfalse;
+    merry_loader_swap_sig(slot, &untyped);
+    loader.slots[slot].thread_safe = mfalse;
+    loader.slots[slot].timeout = 0;
+}
+
 void merry_loader_unloadLib(msize_t handle)
 {
     // this will not throw any error
     // while it should but not now
-    if (handle >= loader.entries)
+    merry_loader_reap();
+    if (handle >= loader.entry_count)
         return;
     if (loader.entries[handle].handle_open == mtrue)
         return; // it is already closed
+    loader.entries[handle].handle_open = mtrue;
+    loader.closed_entry_count++;
+    // the functions are gone with the library
+    // Nobody can start calling them once their slots are freed but the calls that started before may still be running
+    MerryDynClosing *closing = (MerryDynClosing *)calloc(1, sizeof(MerryDynClosing));
+    mbool_t busy = mfalse;
+    for (msize_t i = 0; i < _MERRY_DYN_SLOTS_; i++)
+    {
+        if (loader.slots[i].func == RET_NULL || loader.slots[i].handle != handle)
+            continue;
+        merry_loader_free_slot(i);
+        if (atomic_load(&loader.slots[i].calls) == 0)
+            continue;
+        busy = mtrue;
+        if (closing != NULL)
+            closing->slots[i] = mtrue;
+    }
+    if (busy == mfalse)
+    {
+        free(closing);
 #if defined(_USE_LINUX_)
-    dlclose(loader.entries[handle].lib_handle);
+        dlclose(loader.entries[handle].lib_handle);
 #elif defined(_USE_WIN_)
-    FreeLibrary(loader.entries[handle].lib_handle);
+        FreeLibrary(loader.entries[handle].lib_handle);
 #endif
-    loader.entries[handle].handle_open = mtrue;
-    loader.closed_entry_count++;
+        return;
+    }
+    if (closing == NULL)
+        return; // we can't keep track of it and so it stays loaded
+    closing->lib_handle = loader.entries[handle].lib_handle;
+    closing->next = loader.closing;
+    loader.closing = closing;
 }
 
 dynfunc_t merry_loader_getFuncSymbol(msize_t handle, mstr_t sym_name)
 {
-    if (handle >= loader.entries)
+    if (handle >= loader.entry_count)
         return RET_NULL;
     if (loader.entries[handle].handle_open == mtrue)
         return RET_NULL; // it is already closed
@@ -132,4 +253,264 @@ dynfunc_t merry_loader_getFuncSymbol(msize_t handle, mstr_t sym_name)
     return (dynfunc_t)GetProcAddress(loader.entries[handle].lib_handle, sym_name);
 #endif
     return RET_NULL;
-}
\ No newline at end of file
+}
+
+_MERRY_INTERNAL_ mqword_t merry_loader_hash(mstr_t name)
+{
+    // FNV-1a
+    mqword_t hash = 14695981039346656037ULL;
+    for (; *name != 0; name++)
+        hash = (hash ^ (mbyte_t)*name) * 1099511628211ULL;
+    return hash;
+}
+
+_MERRY_INTERNAL_ msize_t merry_loader_find_slot(msize_t handle, mstr_t sym_name, mqword_t hash)
+{
+    for (msize_t i = 0; i < _MERRY_DYN_SLOTS_; i++)
+    {
+        MerryDynSlot *slot = &loader.slots[i];
+        if (slot->func != RET_NULL && slot->handle == handle && slot->hash == hash && strcmp(slot->name, sym_name) == 0)
+            return i;
+    }
+    return _MERRY_DYN_SLOTS_;
+}
+
+_MERRY_INTERNAL_ msize_t merry_loader_take_slot(msize_t handle, mstr_t sym_name, mqword_t hash, mbool_t bound)
+{
+    // a free slot or, for a bind, one that is only a cache
+    msize_t found = _MERRY_DYN_SLOTS_;
+    for (msize_t i = 0; i < _MERRY_DYN_SLOTS_; i++)
+    {
+        if (loader.slots[i].func == RET_NULL)
+        {
+            found = i;
+            break;
+        }
+        if (bound == mtrue && found == _MERRY_DYN_SLOTS_ && loader.slots[i].bound == mfalse)
+            found = i;
+    }
+    if (found == _MERRY_DYN_SLOTS_)
+        return found;
+    dynfunc_t func = merry_loader_getFuncSymbol(handle, sym_name);
+    mstr_t name;
+    if (func == RET_NULL || (name = strdup(sym_name)) == NULL)
+        return _MERRY_DYN_SLOTS_;
+    MerryDynSlot *slot = &loader.slots[found];
+    atomic_store_explicit(&slot->direct, RET_NULL, memory_order_release); // in case it is being taken over
+    free(slot->name);
+    slot->func = func;
+    slot->handle = handle;
+    slot->hash = hash;
+    slot->name = name;
+    slot->bound = bound;
+    merry_loader_swap_sig(found, &untyped);
+    slot->thread_safe = mfalse;
+    slot->timeout = 0;
+    return found;
+}
+
+mbool_t merry_loader_bind(msize_t handle, mstr_t sym_name, mbool_t thread_safe, msize_t *slot)
+{
+    mqword_t hash = merry_loader_hash(sym_name);
+    if ((*slot = merry_loader_find_slot(handle, sym_name, hash)) == _MERRY_DYN_SLOTS_)
+        *slot = merry_loader_take_slot(handle, sym_name, hash, mtrue);
+    if (*slot == _MERRY_DYN_SLOTS_)
+        return mfalse;
+    loader.slots[*slot].bound = mtrue; // it may have been a cache until now
+    if (thread_safe == mtrue)
+    {
+        loader.slots[*slot].thread_safe = mtrue;
+        if (loader.slots[*slot].timeout == 0)
+            atomic_store_explicit(&loader.slots[*slot].direct, loader.slots[*slot].func, memory_order_release);
+    }
+    return mtrue;
+}
+
+dynfunc_t merry_loader_get_slot(msize_t slot)
+{
+    if (slot >= _MERRY_DYN_SLOTS_)
+        return RET_NULL;
+    return loader.slots[slot].func;
+}
+
+dynfunc_t merry_loader_enter(msize_t slot)
+{
+    if (slot >= _MERRY_DYN_SLOTS_)
+        return RET_NULL;
+    // counted before looking so that an unload that freed the slot before we looked sees us
+    // Both are seq_cst and so either we see that the slot was freed or the unload sees this call
+    MerryDynSlot *s = &loader.slots[slot];
+    atomic_fetch_add(&s->calls, 1);
+    dynfunc_t func = atomic_load(&s->direct);
+    if (func == RET_NULL)
+        atomic_fetch_sub(&s->calls, 1);
+    return func;
+}
+
+void merry_loader_leave(msize_t slot)
+{
+    atomic_fetch_sub(&loader.slots[slot].calls, 1);
+}
+
+void merry_loader_hold(msize_t slot)
+{
+    atomic_fetch_add(&loader.slots[slot].calls, 1);
+}
+
+_MERRY_INTERNAL_ mbool_t merry_loader_parse_sig(MerryDynSig *sig, mstr_t desc)
+{
+    msize_t ints = 0, fps = 0;
+    sig->from_block = *desc == '*';
+    if (sig->from_block == mtrue)
+        desc++;
+    if (*desc == 0 || strchr("vbBhHiIlLfd", *desc) == NULL)
+        return mfalse;
+    sig->ret = *desc++;
+    for (sig->argc = 0; *desc != 0; desc++, sig->argc++)
+    {
+        if (strchr("bBhHiIlLp", *desc) != NULL)
+            ints++;
+        else if (*desc == 'f' || *desc == 'd')
+            fps++;
+        else
+            return mfalse;
+        if (ints > _MERRY_DYN_INT_ARGS_ || fps > _MERRY_DYN_FP_ARGS_)
+            return mfalse;
+        sig->args[sig->argc] = *desc;
+        sig->lens[sig->argc] = 0;
+        if (*desc == 'p' && isdigit((unsigned char)desc[1]))
+        {
+            mstr_t end;
+            sig->lens[sig->argc] = strtoull(desc + 1, &end, 10);
+            desc = end - 1;
+        }
+    }
+    return mtrue;
+}
+
+mbool_t merry_loader_set_sig(msize_t slot, mstr_t desc)
+{
+#if defined(_MERRY_DYN_TYPED_CALLS_)
+    if (merry_loader_get_slot(slot) == RET_NULL)
+        return mfalse;
+    MerryDynSig *sig = (MerryDynSig *)malloc(sizeof(MerryDynSig));
+    if (sig == NULL)
+        return mfalse;
+    if (merry_loader_parse_sig(sig, desc) == mfalse)
+    {
+        free(sig);
+        return mfalse;
+    }
+    sig->typed = mtrue;
+    // a core may be calling it right now with the old one
+    merry_loader_swap_sig(slot, sig);
+    return mtrue;
+#else
+    return mfalse;
+#endif
+}
+
+MerryDynSig *merry_loader_get_sig(msize_t slot)
+{
+    return atomic_load_explicit(&loader.slots[slot].sig, memory_order_acquire);
+}
+
+#if defined(_MERRY_DYN_TYPED_CALLS_)
+#define _MERRY_DYN_SHIM_ARGS_ mqword_t, mqword_t, mqword_t, mqword_t, mqword_t, mqword_t, double, double, double, double, double, double, double, double
+_MERRY_DEFINE_FUNC_PTR_(mqword_t, merry_dyn_ishim_t, _MERRY_DYN_SHIM_ARGS_)
+_MERRY_DEFINE_FUNC_PTR_(double, merry_dyn_dshim_t, _MERRY_DYN_SHIM_ARGS_)
+_MERRY_DEFINE_FUNC_PTR_(float, merry_dyn_fshim_t, _MERRY_DYN_SHIM_ARGS_)
+
+_MERRY_INTERNAL_ mqword_t merry_loader_extend(char type, mqword_t value)
+{
+    // the callee may expect the upper bits to be filled correctly
+    switch (type)
+    {
+    case 'b':
+        return (mqword_t)(msqword_t)(signed char)value;
+    case 'B':
+        return (mbyte_t)value;
+    case 'h':
+        return (mqword_t)(msqword_t)(short)value;
+    case 'H':
+        return (mword_t)value;
+    case 'i':
+        return (mqword_t)(msqword_t)(int)value;
+    case 'I':
+        return (mdword_t)value;
+    }
+    return value;
+}
+#endif
+
+mqword_t merry_loader_call_typed(dynfunc_t func, MerryDynSig *sig, mqptr_t args)
+{
+#if defined(_MERRY_DYN_TYPED_CALLS_)
+    // every integer goes into the next integer register and every float into the next vector register no matter where they are in the list
+    // the function only looks at the registers it has parameters for and so the unused ones can be anything
+    mqword_t ints[_MERRY_DYN_INT_ARGS_] = {0};
+    double fps[_MERRY_DYN_FP_ARGS_] = {0};
+    msize_t ni = 0, nf = 0;
+    for (msize_t i = 0; i < sig->argc; i++)
+    {
+        if (sig->args[i] == 'd')
+            memcpy(&fps[nf++], &args[i], sizeof(double));
+        else if (sig->args[i] == 'f')
+            memcpy(&fps[nf++], &args[i], sizeof(float)); // a float is the lower 4 bytes of the register
+        else
+            ints[ni++] = merry_loader_extend(sig->args[i], args[i]);
+    }
+    mqword_t ret = 0;
+    switch (sig->ret)
+    {
+    case 'd':
+    {
+        double d = ((merry_dyn_dshim_t)(void (*)(void))func)(ints[0], ints[1], ints[2], ints[3], ints[4], ints[5], fps[0], fps[1], fps[2], fps[3], fps[4], fps[5], fps[6], fps[7]);
+        memcpy(&ret, &d, sizeof(d));
+        break;
+    }
+    case 'f':
+    {
+        float f = ((merry_dyn_fshim_t)(void (*)(void))func)(ints[0], ints[1], ints[2], ints[3], ints[4], ints[5], fps[0], fps[1], fps[2], fps[3], fps[4], fps[5], fps[6], fps[7]);
+        memcpy(&ret, &f, sizeof(f));
+        break;
+    }
+    default:
+        ret = ((merry_dyn_ishim_t)(void (*)(void))func)(ints[0], ints[1], ints[2], ints[3], ints[4], ints[5], fps[0], fps[1], fps[2], fps[3], fps[4], fps[5], fps[6], fps[7]);
+        ret = sig->ret == 'v' ? 0 : merry_loader_extend(sig->ret, ret);
+    }
+    return ret;
+#else
+    return 0;
+#endif
+}
+
+dynfunc_t merry_loader_resolve(msize_t handle, mstr_t sym_name, msize_t *slot)
+{
+    mqword_t hash = merry_loader_hash(sym_name);
+    *slot = merry_loader_find_slot(handle, sym_name, hash);
+    if (*slot == _MERRY_DYN_SLOTS_)
+        *slot = merry_loader_take_slot(handle, sym_name, hash, mfalse);
+    if (*slot < _MERRY_DYN_SLOTS_)
+        return loader.slots[*slot].func;
+    // either there is no such function or the slots are all taken
+    return merry_loader_getFuncSymbol(handle, sym_name);
+}
+
+mbool_t merry_loader_set_timeout(msize_t slot, msize_t timeout)
+{
+    if (merry_loader_get_slot(slot) == RET_NULL)
+        return mfalse;
+    MerryDynSlot *s = &loader.slots[slot];
+    s->timeout = timeout;
+    // the cores can't be stopped and so a function with a timeout must go through the call pool
+    atomic_store_explicit(&s->direct, (timeout == 0 && s->thread_safe == mtrue) ? s->func : RET_NULL, memory_order_release);
+    return mtrue;
+}
+
+msize_t merry_loader_get_timeout(msize_t slot)
+{
+    if (slot >= _MERRY_DYN_SLOTS_)
+        return 0;
+    return loader.slots[slot].timeout;
+}
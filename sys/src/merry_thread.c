@@ -26,11 +26,21 @@ MerryCond *merry_cond_init()
     if (cond == NULL)
         return RET_NULL; // failure to allocate
 #if defined(_MERRY_THREADS_POSIX_)
-    if (pthread_cond_init(&cond->cond, NULL) != 0)
+    // the timed waits are measured on the monotonic clock so that changing the system's time doesn't change how long they take
+    pthread_condattr_t attr;
+    if (pthread_condattr_init(&attr) != 0)
     {
         free(cond);
         return RET_NULL;
     }
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (pthread_cond_init(&cond->cond, &attr) != 0)
+    {
+        pthread_condattr_destroy(&attr);
+        free(cond);
+        return RET_NULL;
+    }
+    pthread_condattr_destroy(&attr);
 #elif defined(_MERRY_THREADS_WIN_)
     InitializeConditionVariable(&cond->cond);
 #endif
@@ -109,6 +119,27 @@ void merry_cond_wait(MerryCond *cond, MerryMutex *lock)
 #endif
 }
 
+void merry_cond_timedwait(MerryCond *cond, MerryMutex *lock, msize_t ms)
+{
+    if (surelyF(cond == NULL || lock == NULL))
+        return;
+#if defined(_MERRY_THREADS_POSIX_)
+    // the cond waits on the monotonic clock and wants the time to wake up at
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(&cond->cond, &lock->mutex, &ts);
+#elif defined(_MERRY_THREADS_WIN_)
+    SleepConditionVariableCS(&cond->cond, &lock->mutex, (DWORD)ms);
+#endif
+}
+
 void merry_cond_signal(MerryCond *cond)
 {
     if (surelyF(cond == NULL))
@@ -183,4 +214,13 @@ mret_t merry_thread_join(MerryThread *thread, void *return_val)
     WaitForSingleObject(thread->thread, INFINITE);
 #endif
     return RET_SUCCESS;
-}
\ No newline at end of file
+}
+
+void merry_thread_exit()
+{
+#if defined(_MERRY_THREADS_POSIX_)
+    pthread_exit(NULL);
+#elif defined(_MERRY_THREADS_WIN_)
+    ExitThread(0);
+#endif
+}
@@ -0,0 +1,192 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // for the CPU sets and pthread_setaffinity_np
+#endif
+#include "../merry_topology.h"
+
+_MERRY_INTERNAL_ mret_t merry_topology_parse_list(mcstr_t list, msize_t *cpus, msize_t max, msize_t *count, msize_t limit)
+{
+    // ranges like 0-3 and single CPUs separated by commas; sysfs ends its lists with a newline
+    *count = 0;
+    while (*list != 0 && *list != '\n')
+    {
+        char *end;
+        if (*list < '0' || *list > '9')
+            return RET_FAILURE;
+        msize_t first = strtoull(list, &end, 10), last = first;
+        if (*end == '-')
+        {
+            list = end + 1;
+            if (*list < '0' || *list > '9')
+                return RET_FAILURE;
+            last = strtoull(list, &end, 10);
+        }
+        if (last < first || last >= limit)
+            return RET_FAILURE;
+        for (msize_t cpu = first; cpu <= last; cpu++)
+        {
+            if (*count == max)
+                return RET_FAILURE;
+            cpus[(*count)++] = cpu;
+        }
+        list = end;
+        if (*list == ',')
+            list++;
+        else if (*list != 0 && *list != '\n')
+            return RET_FAILURE;
+    }
+    return *count == 0 ? RET_FAILURE : RET_SUCCESS;
+}
+
+mret_t merry_topology_detect(MerryTopology *topo)
+{
+    memset(topo->node_of, 0, sizeof(topo->node_of));
+    topo->node_count = 1;
+#if defined(_MERRY_HOST_OS_LINUX_)
+    long conf = sysconf(_SC_NPROCESSORS_CONF);
+    topo->cpu_count = (conf <= 0) ? 1 : (conf > _MERRY_MAX_CPUS_ ? _MERRY_MAX_CPUS_ : conf);
+    // every node lists its CPUs; a host without NUMA has no such directory and so it is all node 0
+    char path[64], line[4096];
+    msize_t cpus[_MERRY_MAX_CPUS_], count;
+    for (msize_t node = 0; node < _MERRY_MAX_NODES_; node++)
+    {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%lu/cpulist", node);
+        FILE *file = fopen(path, "r");
+        if (file == NULL)
+            continue; // the node numbers may have holes in them
+        mbool_t read = fgets(line, sizeof(line), file) != NULL;
+        fclose(file);
+        // a node with only memory has an empty list
+        if (read == mfalse || merry_topology_parse_list(line, cpus, _MERRY_MAX_CPUS_, &count, topo->cpu_count) == RET_FAILURE)
+            continue;
+        for (msize_t i = 0; i < count; i++)
+            topo->node_of[cpus[i]] = (mbyte_t)node;
+        topo->node_count = node + 1;
+    }
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    topo->cpu_count = info.dwNumberOfProcessors > _MERRY_MAX_CPUS_ ? _MERRY_MAX_CPUS_ : info.dwNumberOfProcessors;
+#endif
+    return RET_SUCCESS;
+}
+
+mret_t merry_topology_parse_cpus(MerryTopology *topo, mcstr_t list, msize_t *cpus, msize_t max, msize_t *count)
+{
+    return merry_topology_parse_list(list, cpus, max, count, topo->cpu_count);
+}
+
+msize_t merry_topology_node_cpus(MerryTopology *topo, msize_t node, msize_t *cpus, msize_t max)
+{
+    msize_t count = 0;
+    for (msize_t cpu = 0; cpu < topo->cpu_count && count < max; cpu++)
+    {
+        if (topo->node_of[cpu] == node)
+            cpus[count++] = cpu;
+    }
+    return count;
+}
+
+void merry_topology_print_cpus(FILE *stream, msize_t *cpus, msize_t count)
+{
+    for (msize_t i = 0; i < count;)
+    {
+        msize_t j = i;
+        while (j + 1 < count && cpus[j + 1] == cpus[j] + 1)
+            j++;
+        fprintf(stream, (j == i) ? "%s%lu" : "%s%lu-%lu", i == 0 ? "" : ",", cpus[i], cpus[j]);
+        i = j + 1;
+    }
+}
+
+#if defined(_MERRY_HOST_OS_LINUX_)
+mret_t merry_topology_pin(MerryThread *thread, msize_t *cpus, msize_t count)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (msize_t i = 0; i < count; i++)
+        CPU_SET(cpus[i], &set);
+    return pthread_setaffinity_np(thread->thread, sizeof(set), &set) == 0 ? RET_SUCCESS : RET_FAILURE;
+}
+
+mret_t merry_topology_start_pinned(MerryThread *thread, ThreadExecFunc func, mptr_t arg, msize_t *cpus, msize_t count)
+{
+    cpu_set_t set;
+    pthread_attr_t attr;
+    CPU_ZERO(&set);
+    for (msize_t i = 0; i < count; i++)
+        CPU_SET(cpus[i], &set);
+    if (pthread_attr_init(&attr) != 0)
+        return RET_FAILURE;
+    mret_t ret = RET_FAILURE;
+    if (pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) == 0 && pthread_attr_setaffinity_np(&attr, sizeof(set), &set) == 0 && pthread_create(&thread->thread, &attr, func, arg) == 0)
+        ret = RET_SUCCESS;
+    pthread_attr_destroy(&attr);
+    return ret;
+}
+
+_MERRY_INTERNAL_ mret_t merry_topology_mbind(mptr_t addr, msize_t len, int mode, unsigned long *mask)
+{
+    // the kernel reads one bit less than it is told to
+    if (syscall(__NR_mbind, addr, len, mode, mask, _MERRY_MAX_NODES_ + 1, MPOL_MF_MOVE) != 0)
+        return RET_FAILURE;
+    return RET_SUCCESS;
+}
+
+mret_t merry_topology_bind(MerryTopology *topo, mptr_t addr, msize_t len, msize_t node)
+{
+    // preferred and not bound so that the node running out of memory doesn't take the VM down
+    unsigned long mask[_MERRY_MAX_NODES_ / (8 * sizeof(unsigned long))] = {0};
+    if (topo->node_count < 2)
+        return RET_SUCCESS; // nowhere else to put it
+    mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+    return merry_topology_mbind(addr, len, MPOL_PREFERRED, mask);
+}
+
+mret_t merry_topology_interleave(MerryTopology *topo, mptr_t addr, msize_t len)
+{
+    unsigned long mask[_MERRY_MAX_NODES_ / (8 * sizeof(unsigned long))] = {0};
+    if (topo->node_count < 2)
+        return RET_SUCCESS;
+    for (msize_t node = 0; node < topo->node_count; node++)
+        mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    return merry_topology_mbind(addr, len, MPOL_INTERLEAVE, mask);
+}
+#elif defined(_MERRY_HOST_OS_WINDOWS_)
+mret_t merry_topology_pin(MerryThread *thread, msize_t *cpus, msize_t count)
+{
+    // only the first processor group
+    DWORD_PTR mask = 0;
+    for (msize_t i = 0; i < count; i++)
+    {
+        if (cpus[i] < 8 * sizeof(DWORD_PTR))
+            mask |= (DWORD_PTR)1 << cpus[i];
+    }
+    return (mask != 0 && SetThreadAffinityMask(thread->thread, mask) != 0) ? RET_SUCCESS : RET_FAILURE;
+}
+
+mret_t merry_topology_start_pinned(MerryThread *thread, ThreadExecFunc func, mptr_t arg, msize_t *cpus, msize_t count)
+{
+    // the thread is pinned while it is suspended and only then let go
+    thread->thread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)func, arg, CREATE_SUSPENDED, NULL);
+    if (thread->thread == NULL)
+        return RET_FAILURE;
+    if (merry_topology_pin(thread, cpus, count) == RET_FAILURE)
+    {
+        TerminateThread(thread->thread, 0);
+        CloseHandle(thread->thread);
+        return RET_FAILURE;
+    }
+    ResumeThread(thread->thread);
+    return RET_SUCCESS;
+}
+
+mret_t merry_topology_bind(MerryTopology *topo, mptr_t addr, msize_t len, msize_t node)
+{
+    return RET_SUCCESS; // we only ever see one node here
+}
+
+mret_t merry_topology_interleave(MerryTopology *topo, mptr_t addr, msize_t len)
+{
+    return RET_SUCCESS;
+}
+#endif
@@ -0,0 +1,191 @@
+#include "../merry_uring.h"
+
+#if defined(_MERRY_HOST_OS_LINUX_)
+
+_MERRY_INTERNAL_ int merry_uring_enter(MerryURing *ring, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, ring->fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+MerryURing *merry_uring_init(msize_t entries)
+{
+    MerryURing *ring = (MerryURing *)malloc(sizeof(MerryURing));
+    if (ring == NULL)
+        return RET_NULL;
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, (unsigned)entries, &params);
+    if (ring->fd < 0)
+    {
+        // no io_uring on this host or we aren't allowed to use it
+        free(ring);
+        return RET_NULL;
+    }
+    // IORING_OP_READ and IORING_OP_WRITE came along with IORING_FEAT_RW_CUR_POS and one mapping for both rings is older still
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_RW_CUR_POS))
+    {
+        close(ring->fd);
+        free(ring);
+        return RET_NULL;
+    }
+    ring->rings_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    msize_t cq_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (cq_len > ring->rings_len)
+        ring->rings_len = cq_len;
+    ring->rings = mmap(NULL, ring->rings_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->rings == MAP_FAILED)
+    {
+        close(ring->fd);
+        free(ring);
+        return RET_NULL;
+    }
+    ring->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe *)mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        munmap(ring->rings, ring->rings_len);
+        close(ring->fd);
+        free(ring);
+        return RET_NULL;
+    }
+    mbptr_t base = (mbptr_t)ring->rings;
+    ring->sq_head = (unsigned *)(base + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(base + params.sq_off.tail);
+    ring->sq_array = (unsigned *)(base + params.sq_off.array);
+    ring->sq_mask = *(unsigned *)(base + params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+    ring->cq_head = (unsigned *)(base + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(base + params.cq_off.tail);
+    ring->cqes = (struct io_uring_cqe *)(base + params.cq_off.cqes);
+    ring->cq_mask = *(unsigned *)(base + params.cq_off.ring_mask);
+    ring->to_submit = 0;
+    return ring;
+}
+
+mret_t merry_uring_prep(MerryURing *ring, mbyte_t op, int fd, mptr_t buf, msize_t len, mqword_t offset, mqword_t user_data)
+{
+    // only we write the tail and so it can be read plainly while the kernel moves the head
+    unsigned tail = *ring->sq_tail;
+    if (tail - atomic_load_explicit((_Atomic unsigned *)ring->sq_head, memory_order_acquire) == ring->sq_entries)
+        return RET_FAILURE; // full
+    unsigned index = tail & ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    switch (op)
+    {
+    case _MERRY_URING_READ_:
+        sqe->opcode = IORING_OP_READ;
+        break;
+    case _MERRY_URING_WRITE_:
+        sqe->opcode = IORING_OP_WRITE;
+        break;
+    case _MERRY_URING_READV_:
+        sqe->opcode = IORING_OP_READV;
+        break;
+    case _MERRY_URING_WRITEV_:
+        sqe->opcode = IORING_OP_WRITEV;
+        break;
+    default:
+        sqe->opcode = IORING_OP_NOP;
+    }
+    sqe->fd = fd;
+    sqe->addr = (mqword_t)buf;
+    sqe->len = (unsigned)len;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    ring->sq_array[index] = index;
+    // the entry must be visible before the kernel sees the new tail
+    atomic_store_explicit((_Atomic unsigned *)ring->sq_tail, tail + 1, memory_order_release);
+    ring->to_submit++;
+    return RET_SUCCESS;
+}
+
+mret_t merry_uring_submit(MerryURing *ring)
+{
+    while (ring->to_submit > 0)
+    {
+        int ret = merry_uring_enter(ring, ring->to_submit, 0, 0);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return RET_FAILURE;
+        }
+        ring->to_submit -= (unsigned)ret;
+    }
+    return RET_SUCCESS;
+}
+
+mret_t merry_uring_unprep(MerryURing *ring, mqptr_t user_data)
+{
+    // the kernel only looks at the tail when we enter it and so the entries it hasn't taken are still ours
+    if (ring->to_submit == 0)
+        return RET_FAILURE;
+    unsigned tail = *ring->sq_tail - 1;
+    *user_data = ring->sqes[tail & ring->sq_mask].user_data;
+    atomic_store_explicit((_Atomic unsigned *)ring->sq_tail, tail, memory_order_release);
+    ring->to_submit--;
+    return RET_SUCCESS;
+}
+
+mret_t merry_uring_wait(MerryURing *ring, mqptr_t user_data, msqword_t *res)
+{
+    // only we write the head
+    unsigned head = *ring->cq_head;
+    while (head == atomic_load_explicit((_Atomic unsigned *)ring->cq_tail, memory_order_acquire))
+    {
+        // nothing yet and so we sleep in the kernel until something completes
+        if (merry_uring_enter(ring, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+            return RET_FAILURE;
+    }
+    struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+    *user_data = cqe->user_data;
+    *res = cqe->res;
+    // the entry is ours to reuse only after we are done reading it
+    atomic_store_explicit((_Atomic unsigned *)ring->cq_head, head + 1, memory_order_release);
+    return RET_SUCCESS;
+}
+
+void merry_uring_destroy(MerryURing *ring)
+{
+    if (ring == NULL)
+        return;
+    munmap(ring->sqes, ring->sqes_len);
+    munmap(ring->rings, ring->rings_len);
+    close(ring->fd);
+    free(ring);
+}
+
+#else
+
+MerryURing *merry_uring_init(msize_t entries)
+{
+    // the host doesn't have io_uring
+    return RET_NULL;
+}
+
+mret_t merry_uring_prep(MerryURing *ring, mbyte_t op, int fd, mptr_t buf, msize_t len, mqword_t offset, mqword_t user_data)
+{
+    return RET_FAILURE;
+}
+
+mret_t merry_uring_submit(MerryURing *ring)
+{
+    return RET_FAILURE;
+}
+
+mret_t merry_uring_unprep(MerryURing *ring, mqptr_t user_data)
+{
+    return RET_FAILURE;
+}
+
+mret_t merry_uring_wait(MerryURing *ring, mqptr_t user_data, msqword_t *res)
+{
+    return RET_FAILURE;
+}
+
+void merry_uring_destroy(MerryURing *ring)
+{
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../../merry/lib/include/merry_bswap.h"
+
+// gcc -O3 tests/hosttest/bswapbench.c merry/lib/src/merry_bswap.c -o bswapbench
+
+#define QCOUNT (1024UL * 1024 * 1024 / 8) // 1GiB worth of qwords
+
+// how the reader used to invert the byte order
+void old_invert(mqptr_t buf, msize_t count)
+{
+    for (msize_t i = 0; i < count; i++)
+    {
+        mqword_t q = buf[i];
+        buf[i] = ((q & 0xFF) << 56) | (((q >> 8) & 0xFF) << 48) | (((q >> 16) & 0xFF) << 40) | (((q >> 24) & 0xFF) << 32) | (((q >> 32) & 0xFF) << 24) | (((q >> 40) & 0xFF) << 16) | (((q >> 48) & 0xFF) << 8) | ((q >> 56) & 0xFF);
+    }
+}
+
+double run(mbswapfunc_t func, mqptr_t buf)
+{
+    struct timespec s, e;
+    clock_gettime(CLOCK_MONOTONIC, &s);
+    func(buf, QCOUNT);
+    clock_gettime(CLOCK_MONOTONIC, &e);
+    return (e.tv_sec - s.tv_sec) + (e.tv_nsec - s.tv_nsec) / 1e9;
+}
+
+int main()
+{
+    mqptr_t buf = malloc(QCOUNT * 8);
+    if (buf == NULL)
+        return 1;
+    for (msize_t i = 0; i < QCOUNT; i++)
+        buf[i] = i * 0x0102030405060708UL;
+    // every variant runs twice so the buffer should be back to what it was
+    printf("old:     %lfs\n", run(&old_invert, buf) + run(&old_invert, buf));
+    printf("generic: %lfs\n", run(&merry_bswap64_generic, buf) + run(&merry_bswap64_generic, buf));
+    printf("%s: %lfs\n", merry_bswap64_variant(), run(&merry_bswap64, buf) + run(&merry_bswap64, buf));
+    for (msize_t i = 0; i < QCOUNT; i++)
+    {
+        if (buf[i] != i * 0x0102030405060708UL)
+        {
+            printf("Mismatch at %lu\n", i);
+            return 1;
+        }
+    }
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../merry/lib/include/merry_lz4.h"
+
+// Turns a .mbin file into a compressed one until the assembler can do it itself
+// gcc -O3 tests/hosttest/mbinpack.c merry/lib/src/merry_lz4.c -o mbinpack
+// ./mbinpack input.mbin output.mbin
+
+#define PAGE_LEN (1024 * 1024)
+
+msize_t be64(mbptr_t b)
+{
+    msize_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v = (v << 8) | b[i];
+    return v;
+}
+
+void put_be64(mbptr_t b, msize_t v)
+{
+    for (int i = 7; i >= 0; i--, v >>= 8)
+        b[i] = v & 0xFF;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        printf("Usage: %s input.mbin output.mbin\n", argv[0]);
+        return 1;
+    }
+    FILE *in = fopen(argv[1], "rb");
+    if (in == NULL)
+        return 1;
+    fseek(in, 0, SEEK_END);
+    msize_t file_len = ftell(in);
+    rewind(in);
+    mbptr_t file = malloc(file_len);
+    if (file == NULL || fread(file, 1, file_len, in) != file_len || file_len < 32)
+        return 1;
+    fclose(in);
+    if (file[3] & 0x02)
+    {
+        printf("%s is already compressed\n", argv[1]);
+        return 1;
+    }
+    msize_t ilen = be64(file + 8), dlen = be64(file + 16) + be64(file + 24);
+    msize_t icount = (ilen + PAGE_LEN - 1) / PAGE_LEN, dcount = (dlen + PAGE_LEN - 1) / PAGE_LEN;
+    // the only other flag with an extended header is BSS and its word is kept
+    mbool_t bss = (file[3] & 0x04) != 0;
+    mbptr_t payload = bss ? file + 32 + be64(file + 32) : file + 32;
+    msize_t ext_len = 8 * (1 + bss + icount + dcount);
+    mbptr_t ext = malloc(ext_len);
+    mbptr_t chunks = malloc((icount + dcount) * PAGE_LEN);
+    if (ext == NULL || chunks == NULL)
+        return 1;
+    put_be64(ext, ext_len);
+    if (bss)
+        put_be64(ext + 8, be64(file + 40));
+    msize_t total = 0;
+    for (msize_t i = 0; i < icount + dcount; i++)
+    {
+        mbptr_t page = i < icount ? payload + i * PAGE_LEN : payload + ilen + (i - icount) * PAGE_LEN;
+        msize_t left = i < icount ? ilen - i * PAGE_LEN : dlen - (i - icount) * PAGE_LEN;
+        msize_t len = left > PAGE_LEN ? PAGE_LEN : left;
+        // the chunk is stored as is if compressing doesn't make it smaller
+        msize_t clen = merry_lz4_compress(page, len, chunks + total, len - 1);
+        if (clen == 0)
+        {
+            memcpy(chunks + total, page, len);
+            clen = len;
+        }
+        put_be64(ext + 8 * (i + 1 + bss), clen);
+        total += clen;
+    }
+    file[3] |= 0x02;
+    FILE *out = fopen(argv[2], "wb");
+    if (out == NULL)
+        return 1;
+    fwrite(file, 1, 32, out);
+    fwrite(ext, 1, ext_len, out);
+    fwrite(chunks, 1, total, out);
+    fclose(out);
+    printf("%lu bytes -> %lu bytes\n", file_len, 32 + ext_len + total);
+    return 0;
+}
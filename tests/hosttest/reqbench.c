@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../../merry/internals/merry_request_hdlr.h"
+
+// N cores hammering the manager with requests that take no time to fulfill
+// gcc -O3 tests/hosttest/reqbench.c merry/merry_request_queue.c merry/merry_request_hdlr.c sys/src/merry_thread.c -o reqbench
+// ./reqbench [requests per core]
+
+#define MAX_CORES 64
+
+typedef struct Core
+{
+    MerryRequestCompletion completion;
+    msize_t id;
+    msize_t count;
+} Core;
+
+_THRET_T_ core(mptr_t arg)
+{
+    Core *c = (Core *)arg;
+    for (msize_t i = 0; i < c->count; i++)
+        merry_requestHdlr_push_request(_REQ_WRITECHAR, c->id, &c->completion, NULL);
+    return RET_NULL;
+}
+
+double run(msize_t cores, msize_t count)
+{
+    MerryCond *host_cond = merry_cond_init();
+    Core c[MAX_CORES];
+    MerryThread threads[MAX_CORES];
+    struct timespec s, e;
+    if (merry_requestHdlr_init(cores, host_cond) == RET_FAILURE)
+        exit(1);
+    for (msize_t i = 0; i < cores; i++)
+    {
+        c[i].completion.lock = merry_mutex_init();
+        c[i].completion.cond = merry_cond_init();
+        c[i].completion.wake = RET_NULL;
+        atomic_init(&c[i].completion.done, mfalse);
+        c[i].id = i;
+        c[i].count = count;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &s);
+    for (msize_t i = 0; i < cores; i++)
+        merry_create_thread(&threads[i], &core, &c[i]);
+    // this thread is the manager
+    MerryOSRequest req;
+    for (msize_t done = 0; done < cores * count;)
+    {
+        if (merry_requestHdlr_pop_request(&req) == mfalse)
+        {
+            merry_requestHdlr_wait();
+            continue;
+        }
+        merry_requestHdlr_complete(&req);
+        done++;
+    }
+    for (msize_t i = 0; i < cores; i++)
+        merry_thread_join(&threads[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &e);
+    for (msize_t i = 0; i < cores; i++)
+    {
+        merry_mutex_destroy(c[i].completion.lock);
+        merry_cond_destroy(c[i].completion.cond);
+    }
+    merry_requestHdlr_destroy();
+    merry_cond_destroy(host_cond);
+    return (e.tv_sec - s.tv_sec) + (e.tv_nsec - s.tv_nsec) / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    msize_t count = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000;
+    for (msize_t cores = 1; cores <= MAX_CORES; cores <<= 1)
+    {
+        double t = run(cores, count);
+        printf("%2lu cores: %lu requests in %lfs, %.0lf requests/s\n", cores, cores * count, t, (cores * count) / t);
+    }
+    return 0;
+}
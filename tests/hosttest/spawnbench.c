@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../utils/merry_types.h"
+#include "../../merry/internals/merry_opcodes.h"
+
+// Spawning cores one after another where every new core halts right away
+// Once the table is warm, every spawn is a core that is done being given out again
+// gcc -O3 tests/hosttest/spawnbench.c -o spawnbench
+// ./spawnbench <path to merry> [spawns] [options for merry, for eg: -w 4]
+
+#define PROGRAM "spawnbench.mbin"
+#define INST(op, operand) (((mqword_t)(op) << 56) | ((mqword_t)(operand) & 0xFFFFFFFFFFFFFF))
+#define MOVE_IMM(reg, value) INST(OP_MOVE_IMM, ((mqword_t)(reg) << 48) | (value))
+#define REGS(to, from) (((to) << 4) | (from))
+#define CLOCK_MONO 6 // the index of the intrinsic
+#define CHILD 18     // where the new cores start
+
+enum
+{
+    Ma,
+    Mb,
+    Mc,
+    Md,
+    Me,
+    Mf,
+    M1,
+    M2,
+};
+
+void put_be64(mbptr_t b, msize_t v)
+{
+    for (int i = 7; i >= 0; i--, v >>= 8)
+        b[i] = v & 0xFF;
+}
+
+int write_program(msize_t spawns)
+{
+    // the spawns that failed are counted in M2 and the time it took goes in Ma
+    mqword_t insts[] = {
+        INST(OP_ICALL, CLOCK_MONO),             // 0
+        INST(OP_MOVE_REG, REGS(M1, Ma)),        // 1
+        MOVE_IMM(M2, spawns),                   // 2
+        MOVE_IMM(Mc, spawns - 1),               // 3
+        MOVE_IMM(Ma, CHILD),                    // 4
+        INST(OP_INTR, 153),                     // 5 Ma is 1 if the core was made
+        INST(OP_SUB_REG, REGS(M2, Ma)),         // 6
+        INST(OP_LOOP, 4),                       // 7
+        INST(OP_ICALL, CLOCK_MONO),             // 8
+        INST(OP_SUB_REG, REGS(Ma, M1)),         // 9
+        INST(OP_UOUTQ, Ma),                     // 10
+        MOVE_IMM(Mb, ' '),                      // 11
+        INST(OP_COUT, Mb),                      // 12
+        INST(OP_UOUTQ, M2),                     // 13
+        MOVE_IMM(Mb, '\n'),                     // 14
+        INST(OP_COUT, Mb),                      // 15
+        MOVE_IMM(Ma, 0),                        // 16
+        INST(OP_INTR, 152),                     // 17 exit
+        INST(OP_HALT, 0),                       // 18 the new cores
+    };
+    mbyte_t header[32] = {'M', 'I', 'N', 0x01}; // little endian
+    put_be64(header + 8, sizeof(insts));
+    put_be64(header + 16, 0);
+    put_be64(header + 24, 8);
+    mbyte_t strings[8] = {0};
+    FILE *f = fopen(PROGRAM, "wb");
+    if (f == NULL)
+        return 1;
+    fwrite(header, 1, sizeof(header), f);
+    fwrite(insts, 1, sizeof(insts), f);
+    fwrite(strings, 1, sizeof(strings), f);
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <path to merry> [spawns] [options for merry]\n", argv[0]);
+        return 1;
+    }
+    msize_t spawns = argc > 2 ? strtoull(argv[2], NULL, 10) : 100000;
+    if (spawns == 0 || write_program(spawns) != 0)
+        return 1;
+    char cmd[4096];
+    int len = snprintf(cmd, sizeof(cmd), "%s -f %s", argv[1], PROGRAM);
+    for (int i = 3; i < argc && len < (int)sizeof(cmd); i++)
+        len += snprintf(cmd + len, sizeof(cmd) - len, " %s", argv[i]);
+    FILE *vm = popen(cmd, "r");
+    if (vm == NULL)
+        return 1;
+    msize_t ns, failed;
+    int got = fscanf(vm, "%lu %lu", &ns, &failed);
+    pclose(vm);
+    remove(PROGRAM);
+    if (got != 2)
+    {
+        printf("merry didn't run the program\n");
+        return 1;
+    }
+    printf("%lu spawns in %lfs, %.0lf ns per spawn, %lu failed\n", spawns, ns / 1e9, (double)ns / spawns, failed);
+    return 0;
+}